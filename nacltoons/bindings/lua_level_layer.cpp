@@ -19,6 +19,9 @@ TOLUA_API int  tolua_level_layer_open (lua_State* tolua_S);
 #include "lua_level_layer.h"
 #include "level_layer.h"
 #include "game_manager.h"
+#include "physics_node.h"
+#include "stroke_batch.h"
+#include "stroke_node.h"
 #include "tolua_fix.h"
 
 /* function to register type */
@@ -30,6 +33,17 @@ static void tolua_reg_types (lua_State* tolua_S)
  tolua_usertype(tolua_S,"GameManager");
  tolua_usertype(tolua_S,"b2World");
  tolua_usertype(tolua_S,"LevelLayer");
+ tolua_usertype(tolua_S,"PhysicsNode");
+ tolua_usertype(tolua_S,"CCPhysicsNode");
+ tolua_usertype(tolua_S,"b2Body");
+ tolua_usertype(tolua_S,"CCPoint");
+ tolua_usertype(tolua_S,"b2FixtureDef");
+ tolua_usertype(tolua_S,"b2Fixture");
+ tolua_usertype(tolua_S,"StrokeNode");
+ tolua_usertype(tolua_S,"CCNode");
+ tolua_usertype(tolua_S,"CCTexture2D");
+ tolua_usertype(tolua_S,"ccColor3B");
+ tolua_usertype(tolua_S,"StrokeBatch");
 }
 
 /* method: GetWorld of class  LevelLayer */
@@ -126,9 +140,108 @@ static int tolua_level_layer_LevelLayer_ToggleDebug00(lua_State* tolua_S)
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: FindBodiesAt of class  LevelLayer */
-#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_FindBodiesAt00
-static int tolua_level_layer_LevelLayer_FindBodiesAt00(lua_State* tolua_S)
+/* method: SetDebugDrawFlags of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_SetDebugDrawFlags00
+static int tolua_level_layer_LevelLayer_SetDebugDrawFlags00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  uint32 flags = ((uint32)  tolua_tonumber(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'SetDebugDrawFlags'", NULL);
+#endif
+  {
+   self->SetDebugDrawFlags(flags);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'SetDebugDrawFlags'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: GetDebugDrawFlags of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_GetDebugDrawFlags00
+static int tolua_level_layer_LevelLayer_GetDebugDrawFlags00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'GetDebugDrawFlags'", NULL);
+#endif
+  {
+   uint32 tolua_ret = (uint32)  self->GetDebugDrawFlags();
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'GetDebugDrawFlags'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: DumpPhysicsProfile of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_DumpPhysicsProfile00
+static int tolua_level_layer_LevelLayer_DumpPhysicsProfile00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isstring(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  const char* filename = ((const char*)  tolua_tostring(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'DumpPhysicsProfile'", NULL);
+#endif
+  {
+   bool tolua_ret = (bool)  self->DumpPhysicsProfile(filename);
+   tolua_pushboolean(tolua_S,(bool)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'DumpPhysicsProfile'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: QueryPoint of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_QueryPoint00
+static int tolua_level_layer_LevelLayer_QueryPoint00(lua_State* tolua_S)
 {
 #ifndef TOLUA_RELEASE
  tolua_Error tolua_err;
@@ -136,151 +249,1451 @@ static int tolua_level_layer_LevelLayer_FindBodiesAt00(lua_State* tolua_S)
      !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
      !tolua_isusertype(tolua_S,2,"b2Vec2",0,&tolua_err) ||
      (tolua_isvaluenil(tolua_S,3,&tolua_err) || !toluafix_isfunction(tolua_S,3,"LUA_FUNCTION",0,&tolua_err)) ||
-     !tolua_isnoobj(tolua_S,4,&tolua_err)
+     !tolua_isnumber(tolua_S,4,1,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,5,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  b2Vec2* point = ((b2Vec2*)  tolua_tousertype(tolua_S,2,0));
+  LUA_FUNCTION callback = ( toluafix_ref_function(tolua_S,3,0));
+  uint16 mask = ((uint16)  tolua_tonumber(tolua_S,4,0xFFFF));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'QueryPoint'", NULL);
+#endif
+  {
+   self->QueryPoint(point,callback,mask);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'QueryPoint'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: QueryAABB of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_QueryAABB00
+static int tolua_level_layer_LevelLayer_QueryAABB00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"b2Vec2",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,3,"b2Vec2",0,&tolua_err) ||
+     (tolua_isvaluenil(tolua_S,4,&tolua_err) || !toluafix_isfunction(tolua_S,4,"LUA_FUNCTION",0,&tolua_err)) ||
+     !tolua_isnumber(tolua_S,5,1,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,6,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  b2Vec2* lower = ((b2Vec2*)  tolua_tousertype(tolua_S,2,0));
+  b2Vec2* upper = ((b2Vec2*)  tolua_tousertype(tolua_S,3,0));
+  LUA_FUNCTION callback = ( toluafix_ref_function(tolua_S,4,0));
+  uint16 mask = ((uint16)  tolua_tonumber(tolua_S,5,0xFFFF));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'QueryAABB'", NULL);
+#endif
+  {
+   self->QueryAABB(lower,upper,callback,mask);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'QueryAABB'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: QueryRadius of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_QueryRadius00
+static int tolua_level_layer_LevelLayer_QueryRadius00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"b2Vec2",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,3,0,&tolua_err) ||
+     (tolua_isvaluenil(tolua_S,4,&tolua_err) || !toluafix_isfunction(tolua_S,4,"LUA_FUNCTION",0,&tolua_err)) ||
+     !tolua_isnumber(tolua_S,5,1,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,6,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  b2Vec2* center = ((b2Vec2*)  tolua_tousertype(tolua_S,2,0));
+  float radius = ((float)  tolua_tonumber(tolua_S,3,0));
+  LUA_FUNCTION callback = ( toluafix_ref_function(tolua_S,4,0));
+  uint16 mask = ((uint16)  tolua_tonumber(tolua_S,5,0xFFFF));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'QueryRadius'", NULL);
+#endif
+  {
+   self->QueryRadius(center,radius,callback,mask);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'QueryRadius'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: RayCast of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_RayCast00
+static int tolua_level_layer_LevelLayer_RayCast00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"b2Vec2",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,3,"b2Vec2",0,&tolua_err) ||
+     (tolua_isvaluenil(tolua_S,4,&tolua_err) || !toluafix_isfunction(tolua_S,4,"LUA_FUNCTION",0,&tolua_err)) ||
+     !tolua_isnumber(tolua_S,5,1,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,6,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  b2Vec2* from = ((b2Vec2*)  tolua_tousertype(tolua_S,2,0));
+  b2Vec2* to = ((b2Vec2*)  tolua_tousertype(tolua_S,3,0));
+  LUA_FUNCTION callback = ( toluafix_ref_function(tolua_S,4,0));
+  uint16 mask = ((uint16)  tolua_tonumber(tolua_S,5,0xFFFF));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'RayCast'", NULL);
+#endif
+  {
+   self->RayCast(from,to,callback,mask);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'RayCast'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: SetPhysicsEnabled of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_SetPhysicsEnabled00
+static int tolua_level_layer_LevelLayer_SetPhysicsEnabled00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isboolean(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  bool enabled = ((bool)  tolua_toboolean(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'SetPhysicsEnabled'", NULL);
+#endif
+  {
+   self->SetPhysicsEnabled(enabled);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'SetPhysicsEnabled'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: IsPhysicsEnabled of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_IsPhysicsEnabled00
+static int tolua_level_layer_LevelLayer_IsPhysicsEnabled00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'IsPhysicsEnabled'", NULL);
+#endif
+  {
+   bool tolua_ret = (bool)  self->IsPhysicsEnabled();
+   tolua_pushboolean(tolua_S,(bool)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'IsPhysicsEnabled'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: GetPhysicsSubsteps of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_GetPhysicsSubsteps00
+static int tolua_level_layer_LevelLayer_GetPhysicsSubsteps00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'GetPhysicsSubsteps'", NULL);
+#endif
+  {
+   int tolua_ret = (int)  self->GetPhysicsSubsteps();
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'GetPhysicsSubsteps'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: GetDroppedPhysicsTime of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_GetDroppedPhysicsTime00
+static int tolua_level_layer_LevelLayer_GetDroppedPhysicsTime00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'GetDroppedPhysicsTime'", NULL);
+#endif
+  {
+   float tolua_ret = (float)  self->GetDroppedPhysicsTime();
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'GetDroppedPhysicsTime'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: AddContactFilter of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_AddContactFilter00
+static int tolua_level_layer_LevelLayer_AddContactFilter00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,3,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,4,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  int tag1 = ((int)  tolua_tonumber(tolua_S,2,0));
+  int tag2 = ((int)  tolua_tonumber(tolua_S,3,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'AddContactFilter'", NULL);
+#endif
+  {
+   self->AddContactFilter(tag1,tag2);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'AddContactFilter'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: ClearContactFilters of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_ClearContactFilters00
+static int tolua_level_layer_LevelLayer_ClearContactFilters00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'ClearContactFilters'", NULL);
+#endif
+  {
+   self->ClearContactFilters();
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'ClearContactFilters'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: HasContactFilters of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_HasContactFilters00
+static int tolua_level_layer_LevelLayer_HasContactFilters00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'HasContactFilters'", NULL);
+#endif
+  {
+   bool tolua_ret = (bool)  self->HasContactFilters();
+   tolua_pushboolean(tolua_S,(bool)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'HasContactFilters'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: SetIdleThrottling of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_SetIdleThrottling00
+static int tolua_level_layer_LevelLayer_SetIdleThrottling00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isboolean(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  bool enabled = ((bool)  tolua_toboolean(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'SetIdleThrottling'", NULL);
+#endif
+  {
+   self->SetIdleThrottling(enabled);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'SetIdleThrottling'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: IsThrottled of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_IsThrottled00
+static int tolua_level_layer_LevelLayer_IsThrottled00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'IsThrottled'", NULL);
+#endif
+  {
+   bool tolua_ret = (bool)  self->IsThrottled();
+   tolua_pushboolean(tolua_S,(bool)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'IsThrottled'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: Wake of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_Wake00
+static int tolua_level_layer_LevelLayer_Wake00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'Wake'", NULL);
+#endif
+  {
+   self->Wake();
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'Wake'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: GetThrottledTime of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_GetThrottledTime00
+static int tolua_level_layer_LevelLayer_GetThrottledTime00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'GetThrottledTime'", NULL);
+#endif
+  {
+   float tolua_ret = (float)  self->GetThrottledTime();
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'GetThrottledTime'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: AddStaticNode of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_AddStaticNode00
+static int tolua_level_layer_LevelLayer_AddStaticNode00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"CCNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  CCNode* node = ((CCNode*)  tolua_tousertype(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'AddStaticNode'", NULL);
+#endif
+  {
+   self->AddStaticNode(node);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'AddStaticNode'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: RemoveStaticNode of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_RemoveStaticNode00
+static int tolua_level_layer_LevelLayer_RemoveStaticNode00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"CCNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  CCNode* node = ((CCNode*)  tolua_tousertype(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'RemoveStaticNode'", NULL);
+#endif
+  {
+   self->RemoveStaticNode(node);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'RemoveStaticNode'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: InvalidateStaticCache of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_InvalidateStaticCache00
+static int tolua_level_layer_LevelLayer_InvalidateStaticCache00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'InvalidateStaticCache'", NULL);
+#endif
+  {
+   self->InvalidateStaticCache();
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'InvalidateStaticCache'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: SetLevelBounds of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_SetLevelBounds00
+static int tolua_level_layer_LevelLayer_SetLevelBounds00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,3,0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,4,0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,5,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,6,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  float x = ((float)  tolua_tonumber(tolua_S,2,0));
+  float y = ((float)  tolua_tonumber(tolua_S,3,0));
+  float width = ((float)  tolua_tonumber(tolua_S,4,0));
+  float height = ((float)  tolua_tonumber(tolua_S,5,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'SetLevelBounds'", NULL);
+#endif
+  {
+   self->SetLevelBounds(x,y,width,height);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'SetLevelBounds'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: SetCameraTarget of class  LevelLayer */
+#ifndef TOLUA_DISABLE_tolua_level_layer_LevelLayer_SetCameraTarget00
+static int tolua_level_layer_LevelLayer_SetCameraTarget00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"LevelLayer",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"CCNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
+  CCNode* node = ((CCNode*)  tolua_tousertype(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'SetCameraTarget'", NULL);
+#endif
+  {
+   self->SetCameraTarget(node);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'SetCameraTarget'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: sharedManager of class  GameManager */
+#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_sharedManager00
+static int tolua_level_layer_GameManager_sharedManager00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertable(tolua_S,1,"GameManager",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  {
+   GameManager* tolua_ret = (GameManager*)  GameManager::sharedManager();
+    tolua_pushusertype(tolua_S,(void*)tolua_ret,"GameManager");
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'sharedManager'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: Restart of class  GameManager */
+#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_Restart00
+static int tolua_level_layer_GameManager_Restart00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"GameManager",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  GameManager* self = (GameManager*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'Restart'", NULL);
+#endif
+  {
+   self->Restart();
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'Restart'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: LoadLevel of class  GameManager */
+#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_LoadLevel00
+static int tolua_level_layer_GameManager_LoadLevel00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"GameManager",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  GameManager* self = (GameManager*)  tolua_tousertype(tolua_S,1,0);
+  int level_number = ((int)  tolua_tonumber(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'LoadLevel'", NULL);
+#endif
+  {
+   self->LoadLevel(level_number);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'LoadLevel'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: LoadGame of class  GameManager */
+#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_LoadGame00
+static int tolua_level_layer_GameManager_LoadGame00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"GameManager",0,&tolua_err) ||
+     !tolua_isstring(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  GameManager* self = (GameManager*)  tolua_tousertype(tolua_S,1,0);
+  const char* folder = ((const char*)  tolua_tostring(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'LoadGame'", NULL);
+#endif
+  {
+   self->LoadGame(folder);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'LoadGame'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: setB2Body of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_setB2Body00
+static int tolua_level_layer_PhysicsNode_setB2Body00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"b2Body",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+  b2Body* body = ((b2Body*)  tolua_tousertype(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'setB2Body'", NULL);
+#endif
+  {
+   self->setB2Body(body);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'setB2Body'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: create of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_create00
+static int tolua_level_layer_PhysicsNode_create00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertable(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  {
+   PhysicsNode* tolua_ret = (PhysicsNode*)  PhysicsNode::create();
+    tolua_pushusertype(tolua_S,(void*)tolua_ret,"PhysicsNode");
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'create'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: BeginFixtures of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_BeginFixtures00
+static int tolua_level_layer_PhysicsNode_BeginFixtures00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'BeginFixtures'", NULL);
+#endif
+  {
+   self->BeginFixtures();
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'BeginFixtures'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: AddFixture of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_AddFixture00
+static int tolua_level_layer_PhysicsNode_AddFixture00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"b2FixtureDef",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+  b2FixtureDef* fixture_def = ((b2FixtureDef*)  tolua_tousertype(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'AddFixture'", NULL);
+#endif
+  {
+   b2Fixture* tolua_ret = (b2Fixture*)  self->AddFixture(fixture_def);
+    tolua_pushusertype(tolua_S,(void*)tolua_ret,"b2Fixture");
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'AddFixture'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: EndFixtures of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_EndFixtures00
+static int tolua_level_layer_PhysicsNode_EndFixtures00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'EndFixtures'", NULL);
+#endif
+  {
+   self->EndFixtures();
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'EndFixtures'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: MakeDynamic of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_MakeDynamic00
+static int tolua_level_layer_PhysicsNode_MakeDynamic00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,2,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+  uint16 category = ((uint16)  tolua_tonumber(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'MakeDynamic'", NULL);
+#endif
+  {
+   self->MakeDynamic(category);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'MakeDynamic'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: AddStrokePoint of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_AddStrokePoint00
+static int tolua_level_layer_PhysicsNode_AddStrokePoint00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     (tolua_isvaluenil(tolua_S,2,&tolua_err) || !tolua_isusertype(tolua_S,2,"const CCPoint",0,&tolua_err)) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
  )
   goto tolua_lerror;
  else
 #endif
  {
-  LevelLayer* self = (LevelLayer*)  tolua_tousertype(tolua_S,1,0);
-  b2Vec2* pos = ((b2Vec2*)  tolua_tousertype(tolua_S,2,0));
-  LUA_FUNCTION callback = ( toluafix_ref_function(tolua_S,3,0));
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+  const CCPoint* point = ((const CCPoint*)  tolua_tousertype(tolua_S,2,0));
 #ifndef TOLUA_RELEASE
-  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'FindBodiesAt'", NULL);
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'AddStrokePoint'", NULL);
 #endif
   {
-   self->FindBodiesAt(pos,callback);
+   self->AddStrokePoint(*point);
   }
  }
  return 0;
 #ifndef TOLUA_RELEASE
  tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'FindBodiesAt'.",&tolua_err);
+ tolua_error(tolua_S,"#ferror in function 'AddStrokePoint'.",&tolua_err);
  return 0;
 #endif
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: sharedManager of class  GameManager */
-#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_sharedManager00
-static int tolua_level_layer_GameManager_sharedManager00(lua_State* tolua_S)
+/* method: GetStrokePointCount of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_GetStrokePointCount00
+static int tolua_level_layer_PhysicsNode_GetStrokePointCount00(lua_State* tolua_S)
 {
 #ifndef TOLUA_RELEASE
  tolua_Error tolua_err;
  if (
-     !tolua_isusertable(tolua_S,1,"GameManager",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
      !tolua_isnoobj(tolua_S,2,&tolua_err)
  )
   goto tolua_lerror;
  else
 #endif
  {
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'GetStrokePointCount'", NULL);
+#endif
   {
-   GameManager* tolua_ret = (GameManager*)  GameManager::sharedManager();
-    tolua_pushusertype(tolua_S,(void*)tolua_ret,"GameManager");
+   int tolua_ret = (int)  self->GetStrokePointCount();
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
   }
  }
  return 1;
 #ifndef TOLUA_RELEASE
  tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'sharedManager'.",&tolua_err);
+ tolua_error(tolua_S,"#ferror in function 'GetStrokePointCount'.",&tolua_err);
  return 0;
 #endif
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: Restart of class  GameManager */
-#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_Restart00
-static int tolua_level_layer_GameManager_Restart00(lua_State* tolua_S)
+/* method: FinishStroke of class  PhysicsNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_PhysicsNode_FinishStroke00
+static int tolua_level_layer_PhysicsNode_FinishStroke00(lua_State* tolua_S)
 {
 #ifndef TOLUA_RELEASE
  tolua_Error tolua_err;
  if (
-     !tolua_isusertype(tolua_S,1,"GameManager",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,1,"PhysicsNode",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"b2FixtureDef",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,3,0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,4,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,5,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  PhysicsNode* self = (PhysicsNode*)  tolua_tousertype(tolua_S,1,0);
+  b2FixtureDef* fixture_def = ((b2FixtureDef*)  tolua_tousertype(tolua_S,2,0));
+  float thickness = ((float)  tolua_tonumber(tolua_S,3,0));
+  float tolerance = ((float)  tolua_tonumber(tolua_S,4,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'FinishStroke'", NULL);
+#endif
+  {
+   int tolua_ret = (int)  self->FinishStroke(fixture_def,thickness,tolerance);
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'FinishStroke'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: create of class  StrokeNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeNode_create00
+static int tolua_level_layer_StrokeNode_create00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertable(tolua_S,1,"StrokeNode",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"CCTexture2D",0,&tolua_err) ||
+     !tolua_isnumber(tolua_S,3,0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,4,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  CCTexture2D* texture = ((CCTexture2D*)  tolua_tousertype(tolua_S,2,0));
+  float thickness = ((float)  tolua_tonumber(tolua_S,3,0));
+  {
+   StrokeNode* tolua_ret = (StrokeNode*)  StrokeNode::create(texture,thickness);
+    int nID = (tolua_ret) ? (int)tolua_ret->m_uID : -1;
+    int* pLuaID = (tolua_ret) ? &tolua_ret->m_nLuaID : NULL;
+    toluafix_pushusertype_ccobject(tolua_S, nID, pLuaID, (void*)tolua_ret,"StrokeNode");
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'create'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: AddPoint of class  StrokeNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeNode_AddPoint00
+static int tolua_level_layer_StrokeNode_AddPoint00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"StrokeNode",0,&tolua_err) ||
+     (tolua_isvaluenil(tolua_S,2,&tolua_err) || !tolua_isusertype(tolua_S,2,"const CCPoint",0,&tolua_err)) ||
+     (tolua_isvaluenil(tolua_S,3,&tolua_err) || !tolua_isusertype(tolua_S,3,"const ccColor3B",0,&tolua_err)) ||
+     !tolua_isnoobj(tolua_S,4,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  StrokeNode* self = (StrokeNode*)  tolua_tousertype(tolua_S,1,0);
+  const CCPoint* point = ((const CCPoint*)  tolua_tousertype(tolua_S,2,0));
+  const ccColor3B* color = ((const ccColor3B*)  tolua_tousertype(tolua_S,3,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'AddPoint'", NULL);
+#endif
+  {
+   self->AddPoint(*point,*color);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'AddPoint'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: AddLine of class  StrokeNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeNode_AddLine00
+static int tolua_level_layer_StrokeNode_AddLine00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"StrokeNode",0,&tolua_err) ||
+     (tolua_isvaluenil(tolua_S,2,&tolua_err) || !tolua_isusertype(tolua_S,2,"const CCPoint",0,&tolua_err)) ||
+     (tolua_isvaluenil(tolua_S,3,&tolua_err) || !tolua_isusertype(tolua_S,3,"const CCPoint",0,&tolua_err)) ||
+     (tolua_isvaluenil(tolua_S,4,&tolua_err) || !tolua_isusertype(tolua_S,4,"const ccColor3B",0,&tolua_err)) ||
+     !tolua_isnoobj(tolua_S,5,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  StrokeNode* self = (StrokeNode*)  tolua_tousertype(tolua_S,1,0);
+  const CCPoint* from = ((const CCPoint*)  tolua_tousertype(tolua_S,2,0));
+  const CCPoint* to = ((const CCPoint*)  tolua_tousertype(tolua_S,3,0));
+  const ccColor3B* color = ((const ccColor3B*)  tolua_tousertype(tolua_S,4,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'AddLine'", NULL);
+#endif
+  {
+   self->AddLine(*from,*to,*color);
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'AddLine'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: ClosePolyline of class  StrokeNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeNode_ClosePolyline00
+static int tolua_level_layer_StrokeNode_ClosePolyline00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"StrokeNode",0,&tolua_err) ||
      !tolua_isnoobj(tolua_S,2,&tolua_err)
  )
   goto tolua_lerror;
  else
 #endif
  {
-  GameManager* self = (GameManager*)  tolua_tousertype(tolua_S,1,0);
+  StrokeNode* self = (StrokeNode*)  tolua_tousertype(tolua_S,1,0);
 #ifndef TOLUA_RELEASE
-  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'Restart'", NULL);
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'ClosePolyline'", NULL);
 #endif
   {
-   self->Restart();
+   self->ClosePolyline();
   }
  }
  return 0;
 #ifndef TOLUA_RELEASE
  tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'Restart'.",&tolua_err);
+ tolua_error(tolua_S,"#ferror in function 'ClosePolyline'.",&tolua_err);
  return 0;
 #endif
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: LoadLevel of class  GameManager */
-#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_LoadLevel00
-static int tolua_level_layer_GameManager_LoadLevel00(lua_State* tolua_S)
+/* method: Clear of class  StrokeNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeNode_Clear00
+static int tolua_level_layer_StrokeNode_Clear00(lua_State* tolua_S)
 {
 #ifndef TOLUA_RELEASE
  tolua_Error tolua_err;
  if (
-     !tolua_isusertype(tolua_S,1,"GameManager",0,&tolua_err) ||
-     !tolua_isnumber(tolua_S,2,0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,1,"StrokeNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  StrokeNode* self = (StrokeNode*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'Clear'", NULL);
+#endif
+  {
+   self->Clear();
+  }
+ }
+ return 0;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'Clear'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: GetPointCount of class  StrokeNode */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeNode_GetPointCount00
+static int tolua_level_layer_StrokeNode_GetPointCount00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"StrokeNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  StrokeNode* self = (StrokeNode*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'GetPointCount'", NULL);
+#endif
+  {
+   int tolua_ret = (int)  self->GetPointCount();
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'GetPointCount'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: create of class  StrokeBatch */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeBatch_create00
+static int tolua_level_layer_StrokeBatch_create00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertable(tolua_S,1,"StrokeBatch",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"CCTexture2D",0,&tolua_err) ||
      !tolua_isnoobj(tolua_S,3,&tolua_err)
  )
   goto tolua_lerror;
  else
 #endif
  {
-  GameManager* self = (GameManager*)  tolua_tousertype(tolua_S,1,0);
-  int level_number = ((int)  tolua_tonumber(tolua_S,2,0));
+  CCTexture2D* texture = ((CCTexture2D*)  tolua_tousertype(tolua_S,2,0));
+  {
+   StrokeBatch* tolua_ret = (StrokeBatch*)  StrokeBatch::create(texture);
+    int nID = (tolua_ret) ? (int)tolua_ret->m_uID : -1;
+    int* pLuaID = (tolua_ret) ? &tolua_ret->m_nLuaID : NULL;
+    toluafix_pushusertype_ccobject(tolua_S, nID, pLuaID, (void*)tolua_ret,"StrokeBatch");
+  }
+ }
+ return 1;
 #ifndef TOLUA_RELEASE
-  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'LoadLevel'", NULL);
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'create'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: getTexture of class  StrokeBatch */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeBatch_getTexture00
+static int tolua_level_layer_StrokeBatch_getTexture00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"StrokeBatch",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  StrokeBatch* self = (StrokeBatch*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'getTexture'", NULL);
 #endif
   {
-   self->LoadLevel(level_number);
+   CCTexture2D* tolua_ret = (CCTexture2D*)  self->getTexture();
+    int nID = (tolua_ret) ? (int)tolua_ret->m_uID : -1;
+    int* pLuaID = (tolua_ret) ? &tolua_ret->m_nLuaID : NULL;
+    toluafix_pushusertype_ccobject(tolua_S, nID, pLuaID, (void*)tolua_ret,"CCTexture2D");
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'getTexture'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: AddStroke of class  StrokeBatch */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeBatch_AddStroke00
+static int tolua_level_layer_StrokeBatch_AddStroke00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"StrokeBatch",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"StrokeNode",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,3,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  StrokeBatch* self = (StrokeBatch*)  tolua_tousertype(tolua_S,1,0);
+  StrokeNode* stroke = ((StrokeNode*)  tolua_tousertype(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'AddStroke'", NULL);
+#endif
+  {
+   self->AddStroke(stroke);
   }
  }
  return 0;
 #ifndef TOLUA_RELEASE
  tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'LoadLevel'.",&tolua_err);
+ tolua_error(tolua_S,"#ferror in function 'AddStroke'.",&tolua_err);
  return 0;
 #endif
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: LoadGame of class  GameManager */
-#ifndef TOLUA_DISABLE_tolua_level_layer_GameManager_LoadGame00
-static int tolua_level_layer_GameManager_LoadGame00(lua_State* tolua_S)
+/* method: RemoveStroke of class  StrokeBatch */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeBatch_RemoveStroke00
+static int tolua_level_layer_StrokeBatch_RemoveStroke00(lua_State* tolua_S)
 {
 #ifndef TOLUA_RELEASE
  tolua_Error tolua_err;
  if (
-     !tolua_isusertype(tolua_S,1,"GameManager",0,&tolua_err) ||
-     !tolua_isstring(tolua_S,2,0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,1,"StrokeBatch",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"StrokeNode",0,&tolua_err) ||
      !tolua_isnoobj(tolua_S,3,&tolua_err)
  )
   goto tolua_lerror;
  else
 #endif
  {
-  GameManager* self = (GameManager*)  tolua_tousertype(tolua_S,1,0);
-  const char* folder = ((const char*)  tolua_tostring(tolua_S,2,0));
+  StrokeBatch* self = (StrokeBatch*)  tolua_tousertype(tolua_S,1,0);
+  StrokeNode* stroke = ((StrokeNode*)  tolua_tousertype(tolua_S,2,0));
 #ifndef TOLUA_RELEASE
-  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'LoadGame'", NULL);
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'RemoveStroke'", NULL);
 #endif
   {
-   self->LoadGame(folder);
+   self->RemoveStroke(stroke);
   }
  }
  return 0;
 #ifndef TOLUA_RELEASE
  tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'LoadGame'.",&tolua_err);
+ tolua_error(tolua_S,"#ferror in function 'RemoveStroke'.",&tolua_err);
+ return 0;
+#endif
+}
+#endif //#ifndef TOLUA_DISABLE
+
+/* method: GetStrokeCount of class  StrokeBatch */
+#ifndef TOLUA_DISABLE_tolua_level_layer_StrokeBatch_GetStrokeCount00
+static int tolua_level_layer_StrokeBatch_GetStrokeCount00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+ tolua_Error tolua_err;
+ if (
+     !tolua_isusertype(tolua_S,1,"StrokeBatch",0,&tolua_err) ||
+     !tolua_isnoobj(tolua_S,2,&tolua_err)
+ )
+  goto tolua_lerror;
+ else
+#endif
+ {
+  StrokeBatch* self = (StrokeBatch*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'GetStrokeCount'", NULL);
+#endif
+  {
+   int tolua_ret = (int)  self->GetStrokeCount();
+   tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+  }
+ }
+ return 1;
+#ifndef TOLUA_RELEASE
+ tolua_lerror:
+ tolua_error(tolua_S,"#ferror in function 'GetStrokeCount'.",&tolua_err);
  return 0;
 #endif
 }
@@ -298,7 +1711,29 @@ TOLUA_API int tolua_level_layer_open (lua_State* tolua_S)
    tolua_function(tolua_S,"GetWorld",tolua_level_layer_LevelLayer_GetWorld00);
    tolua_function(tolua_S,"LevelComplete",tolua_level_layer_LevelLayer_LevelComplete00);
    tolua_function(tolua_S,"ToggleDebug",tolua_level_layer_LevelLayer_ToggleDebug00);
-   tolua_function(tolua_S,"FindBodiesAt",tolua_level_layer_LevelLayer_FindBodiesAt00);
+   tolua_function(tolua_S,"SetDebugDrawFlags",tolua_level_layer_LevelLayer_SetDebugDrawFlags00);
+   tolua_function(tolua_S,"GetDebugDrawFlags",tolua_level_layer_LevelLayer_GetDebugDrawFlags00);
+   tolua_function(tolua_S,"DumpPhysicsProfile",tolua_level_layer_LevelLayer_DumpPhysicsProfile00);
+   tolua_function(tolua_S,"QueryPoint",tolua_level_layer_LevelLayer_QueryPoint00);
+   tolua_function(tolua_S,"QueryAABB",tolua_level_layer_LevelLayer_QueryAABB00);
+   tolua_function(tolua_S,"QueryRadius",tolua_level_layer_LevelLayer_QueryRadius00);
+   tolua_function(tolua_S,"RayCast",tolua_level_layer_LevelLayer_RayCast00);
+   tolua_function(tolua_S,"SetPhysicsEnabled",tolua_level_layer_LevelLayer_SetPhysicsEnabled00);
+   tolua_function(tolua_S,"IsPhysicsEnabled",tolua_level_layer_LevelLayer_IsPhysicsEnabled00);
+   tolua_function(tolua_S,"GetPhysicsSubsteps",tolua_level_layer_LevelLayer_GetPhysicsSubsteps00);
+   tolua_function(tolua_S,"GetDroppedPhysicsTime",tolua_level_layer_LevelLayer_GetDroppedPhysicsTime00);
+   tolua_function(tolua_S,"AddContactFilter",tolua_level_layer_LevelLayer_AddContactFilter00);
+   tolua_function(tolua_S,"ClearContactFilters",tolua_level_layer_LevelLayer_ClearContactFilters00);
+   tolua_function(tolua_S,"HasContactFilters",tolua_level_layer_LevelLayer_HasContactFilters00);
+   tolua_function(tolua_S,"SetIdleThrottling",tolua_level_layer_LevelLayer_SetIdleThrottling00);
+   tolua_function(tolua_S,"IsThrottled",tolua_level_layer_LevelLayer_IsThrottled00);
+   tolua_function(tolua_S,"Wake",tolua_level_layer_LevelLayer_Wake00);
+   tolua_function(tolua_S,"GetThrottledTime",tolua_level_layer_LevelLayer_GetThrottledTime00);
+   tolua_function(tolua_S,"AddStaticNode",tolua_level_layer_LevelLayer_AddStaticNode00);
+   tolua_function(tolua_S,"RemoveStaticNode",tolua_level_layer_LevelLayer_RemoveStaticNode00);
+   tolua_function(tolua_S,"InvalidateStaticCache",tolua_level_layer_LevelLayer_InvalidateStaticCache00);
+   tolua_function(tolua_S,"SetLevelBounds",tolua_level_layer_LevelLayer_SetLevelBounds00);
+   tolua_function(tolua_S,"SetCameraTarget",tolua_level_layer_LevelLayer_SetCameraTarget00);
   tolua_endmodule(tolua_S);
   tolua_cclass(tolua_S,"GameManager","GameManager","",NULL);
   tolua_beginmodule(tolua_S,"GameManager");
@@ -307,6 +1742,35 @@ TOLUA_API int tolua_level_layer_open (lua_State* tolua_S)
    tolua_function(tolua_S,"LoadLevel",tolua_level_layer_GameManager_LoadLevel00);
    tolua_function(tolua_S,"LoadGame",tolua_level_layer_GameManager_LoadGame00);
   tolua_endmodule(tolua_S);
+  tolua_cclass(tolua_S,"PhysicsNode","PhysicsNode","CCPhysicsNode",NULL);
+  tolua_beginmodule(tolua_S,"PhysicsNode");
+   tolua_function(tolua_S,"setB2Body",tolua_level_layer_PhysicsNode_setB2Body00);
+   tolua_function(tolua_S,"create",tolua_level_layer_PhysicsNode_create00);
+   tolua_function(tolua_S,"BeginFixtures",tolua_level_layer_PhysicsNode_BeginFixtures00);
+   tolua_function(tolua_S,"AddFixture",tolua_level_layer_PhysicsNode_AddFixture00);
+   tolua_function(tolua_S,"EndFixtures",tolua_level_layer_PhysicsNode_EndFixtures00);
+   tolua_function(tolua_S,"MakeDynamic",tolua_level_layer_PhysicsNode_MakeDynamic00);
+   tolua_function(tolua_S,"AddStrokePoint",tolua_level_layer_PhysicsNode_AddStrokePoint00);
+   tolua_function(tolua_S,"GetStrokePointCount",tolua_level_layer_PhysicsNode_GetStrokePointCount00);
+   tolua_function(tolua_S,"FinishStroke",tolua_level_layer_PhysicsNode_FinishStroke00);
+  tolua_endmodule(tolua_S);
+  tolua_cclass(tolua_S,"StrokeNode","StrokeNode","CCNode",NULL);
+  tolua_beginmodule(tolua_S,"StrokeNode");
+   tolua_function(tolua_S,"create",tolua_level_layer_StrokeNode_create00);
+   tolua_function(tolua_S,"AddPoint",tolua_level_layer_StrokeNode_AddPoint00);
+   tolua_function(tolua_S,"AddLine",tolua_level_layer_StrokeNode_AddLine00);
+   tolua_function(tolua_S,"ClosePolyline",tolua_level_layer_StrokeNode_ClosePolyline00);
+   tolua_function(tolua_S,"Clear",tolua_level_layer_StrokeNode_Clear00);
+   tolua_function(tolua_S,"GetPointCount",tolua_level_layer_StrokeNode_GetPointCount00);
+  tolua_endmodule(tolua_S);
+  tolua_cclass(tolua_S,"StrokeBatch","StrokeBatch","CCNode",NULL);
+  tolua_beginmodule(tolua_S,"StrokeBatch");
+   tolua_function(tolua_S,"create",tolua_level_layer_StrokeBatch_create00);
+   tolua_function(tolua_S,"getTexture",tolua_level_layer_StrokeBatch_getTexture00);
+   tolua_function(tolua_S,"AddStroke",tolua_level_layer_StrokeBatch_AddStroke00);
+   tolua_function(tolua_S,"RemoveStroke",tolua_level_layer_StrokeBatch_RemoveStroke00);
+   tolua_function(tolua_S,"GetStrokeCount",tolua_level_layer_StrokeBatch_GetStrokeCount00);
+  tolua_endmodule(tolua_S);
  tolua_endmodule(tolua_S);
  return 1;
 }
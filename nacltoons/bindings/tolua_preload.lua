@@ -10,6 +10,9 @@ _push_functions = _push_functions or {}
 
 local CCObjectTypes = {
     "CCPhysicsSprite",
+    "CCTexture2D",
+    "StrokeBatch",
+    "StrokeNode",
 }
 
 -- register CCObject types
@@ -0,0 +1,140 @@
+-- Copyright (c) 2013 The Chromium Authors. All rights reserved.
+-- Use of this source code is governed by a BSD-style license that can be
+-- found in the LICENSE file.
+
+-- Compiles game data files (.def files) into the binary format read
+-- by the levelfile module (see src/level_file.h).  Compiled files
+-- are written next to the .def files they come from with a .bin
+-- extension and are loaded in their place when they are up to date,
+-- which saves parsing yaml and validating the level at runtime.
+-- Each compiled file records the size and checksum of its .def file
+-- so that it is never used once the .def file has been edited.
+-- The .def files remain the authoring format.
+--
+-- To compile a game and all its levels:
+-- $ ./lua.sh ./data/res/compile.lua data/res/sample_game/game.def
+
+local path = require 'path'
+local util = require 'util'
+local validate = require 'validate'
+local yaml = require 'yaml'
+
+local compile = {}
+
+local MAGIC = 'NTLV'
+local VERSION = 2
+
+local function EncodeUint32(value)
+    return string.char(value % 256,
+                       math.floor(value / 256) % 256,
+                       math.floor(value / 65536) % 256,
+                       math.floor(value / 16777216) % 256)
+end
+
+--- Return the Adler-32 checksum of a string.
+local function Checksum(data)
+    local a, b = 1, 0
+    for i = 1, #data do
+        a = (a + data:byte(i)) % 65521
+        b = (b + a) % 65521
+    end
+    return b * 65536 + a
+end
+
+--- Return a description of where a value is for error messages.
+local function KeyPath(where, key)
+    if type(key) == 'number' then
+        return where .. '[' .. key .. ']'
+    end
+    return where .. '.' .. tostring(key)
+end
+
+local function EncodeValue(value, out, where)
+    local value_type = type(value)
+    if value == yaml.null then
+        out[#out + 1] = 'N'
+    elseif value_type == 'boolean' then
+        out[#out + 1] = value and 'T' or 'F'
+    elseif value_type == 'number' then
+        if value == math.floor(value) and value >= -2147483648 and value < 2147483648 then
+            out[#out + 1] = 'i' .. EncodeUint32(value % 4294967296)
+        else
+            local text = string.format('%.17g', value)
+            out[#out + 1] = 'd' .. string.char(#text) .. text
+        end
+    elseif value_type == 'string' then
+        out[#out + 1] = 's' .. EncodeUint32(#value) .. value
+    elseif value_type == 'table' then
+        local array_count = #value
+        local keys = {}
+        for key, _ in pairs(value) do
+            if type(key) ~= 'number' or key < 1 or key > array_count or key ~= math.floor(key) then
+                keys[#keys + 1] = key
+            end
+        end
+        -- Sort the keys so that compiling the same data always gives
+        -- the same output.
+        table.sort(keys, function(a, b) return tostring(a) < tostring(b) end)
+        out[#out + 1] = 't' .. EncodeUint32(array_count) .. EncodeUint32(#keys)
+        for i = 1, array_count do
+            EncodeValue(value[i], out, KeyPath(where, i))
+        end
+        for _, key in ipairs(keys) do
+            EncodeValue(key, out, where)
+            EncodeValue(value[key], out, KeyPath(where, key))
+        end
+    else
+        error('cannot compile value of type ' .. value_type .. ' at ' .. where)
+    end
+end
+
+--- Return the binary encoding of a lua value.
+-- @param value the value to encode
+-- @param source the text of the .def file the value was loaded from
+function compile.Encode(value, source)
+    source = source or ''
+    local out = { MAGIC, string.char(VERSION),
+                  EncodeUint32(#source), EncodeUint32(Checksum(source)) }
+    EncodeValue(value, out, '<root>')
+    return table.concat(out)
+end
+
+--- Compile a .def file, writing the result next to it.
+-- @param filename the .def file that the value was loaded from
+-- @param value the (validated) contents of the file
+function compile.WriteFile(filename, value)
+    local f = assert(io.open(filename, 'rb'))
+    local source = f:read('*all')
+    f:close()
+    f = assert(io.open(util.CompiledFilename(filename), 'wb'))
+    f:write(compile.Encode(value, source))
+    f:close()
+end
+
+--- Validate and compile a game.def file and all of its levels.
+-- @param filename the game.def file to compile
+function compile.CompileGame(filename)
+    local gamedef = util.LoadYaml(filename)
+    -- Validation resolves asset paths in place, so the game def is
+    -- validated as a copy.  Compiled game defs are still validated
+    -- when they are loaded.
+    local checked = util.LoadYaml(filename)
+    checked.root = path.dirname(filename)
+    validate.ValidateGameDef(filename, checked)
+    compile.WriteFile(filename, gamedef)
+
+    for _, level in ipairs(gamedef.levels) do
+        local level_filename = path.join(checked.root, level)
+        local leveldef = util.LoadYaml(level_filename)
+        validate.ValidateLevelDef(level_filename, checked, leveldef)
+        compile.WriteFile(level_filename, leveldef)
+    end
+end
+
+if debug.getinfo(1).what == "main" and debug.getinfo(3) == nil then
+   -- When run from the command line compile the passed in game.def file.
+   compile.CompileGame(arg[1])
+   print("Compilation successful!")
+end
+
+return compile
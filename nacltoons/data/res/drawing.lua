@@ -6,11 +6,17 @@
 -- This module defines a single 'drawing' global containing the following
 -- functions:
 --   - SetBrush
+--   - SetBrushSize
 --   - CreateShape
---   - CreateSprite
+--   - CreateShapes
 --   - DrawStartPoint
+--   - DrawCircle
 --   - DrawEndPoint
 --   - AddLineToShape
+--   - AddLineToStroke
+--   - FinishStroke
+--   - IsDrawing
+--   - DestroySprite
 --   - OnTouchBegan
 --   - OnTouchMoved
 --   - OnTouchEnded
@@ -29,6 +35,8 @@ drawing.mode = drawing.MODE_FREEHAND
 
 -- Brush information (set by SetBrush)
 local brush_tex
+local brush_batch
+local static_brush_batch
 local brush_thickness
 
 -- Constant for grouping physics bodies
@@ -36,12 +44,14 @@ local MAIN_CATEGORY = 0x1
 local DRAWING_CATEGORY = 0x2
 
 -- Constants for tagging cocos nodes
-local TAG_BATCH_NODE = 0x1
+local TAG_STROKE_NODE = 0x1
 
--- Starting batch size for CCSpriteBatchNode.  We override
--- the default since we often have many sprites in each
--- node (each drawn element is it own batch node).
-local DEFAULT_BATCH_COUNT = 100
+-- Material used for all shapes, whether drawn or loaded from a level.
+local MATERIAL = { density = 1.0, friction = 0.5, restitution = 0.3 }
+
+-- How far (as a fraction of the brush thickness) a freehand stroke's
+-- physics shape can stray from the points that were drawn.
+local STROKE_TOLERANCE = 0.5
 
 -- Local state for default touch handlers
 local current_shape = nil
@@ -55,45 +65,52 @@ local brush_color = ccc3(255, 100, 100)
 -- drawn objects.
 drawing.handlers = {}
 
---- Create a b2Vec from a lua list containing 2 elements.
--- This is used to convert point data from .def files directly
--- to the box2dx coordinate system
-local function b2VecFromLua(luapoint)
-    local ccpoint = util.PointFromLua(luapoint)
-    local rtn = util.b2VecFromCocos(ccpoint)
-    return rtn
+--- In headless mode no sprites are created, only physics bodies.
+local function IsHeadless()
+    return game_obj.headless
 end
 
-local function CreateBrushBatch(parent)
-    local node = CCSpriteBatchNode:createWithTexture(brush_tex, DEFAULT_BATCH_COUNT)
+--- Create the node that holds a shape's brush strokes.  The node stays
+-- a child of the shape so it follows the shape's body, but it is drawn
+-- by the level's brush batch along with every other shape's strokes.
+-- Shapes that never move use the static batch.
+local function CreateStrokeNode(parent, static)
+    if IsHeadless() then
+        return nil
+    end
+    local node = StrokeNode:create(brush_tex, brush_thickness)
     assert(node)
-    parent:addChild(node, 1, TAG_BATCH_NODE)
+    parent:addChild(node, 1, TAG_STROKE_NODE)
+    if static and static_brush_batch then
+        static_brush_batch:AddStroke(node)
+    else
+        brush_batch:AddStroke(node)
+    end
     return node
 end
 
---- Create a fixed pivot point between the world and the given body.
-local function CreatePivot(anchor, body)
-    local anchor_point = util.b2VecFromCocos(anchor)
-
-    -- create a new fixed body to pivot against
-    local ground_def = b2BodyDef:new_local()
-    ground_def.position = anchor_point
-    local ground_body = level_obj.world:CreateBody(ground_def);
-
-    -- create the pivot joint
-    local joint_def = b2RevoluteJointDef:new_local()
-    joint_def:Initialize(ground_body, body, anchor_point)
-    local joint = level_obj.world:CreateJoint(joint_def)
+local function GetStrokeNode(parent)
+    local node = parent:getChildByTag(TAG_STROKE_NODE)
+    assert(node)
+    return tolua.cast(node, 'StrokeNode')
 end
 
-local function AddShapeToBody(body, shape, sensor)
+--- Create a fixture def with the material used for all drawn shapes.
+local function CreateFixtureDef(sensor)
     local fixture_def = b2FixtureDef:new_local()
-    fixture_def.shape = shape
-    fixture_def.density = 1.0
-    fixture_def.friction = 0.5
-    fixture_def.restitution = 0.3
+    fixture_def.density = MATERIAL.density
+    fixture_def.friction = MATERIAL.friction
+    fixture_def.restitution = MATERIAL.restitution
     fixture_def.isSensor = sensor
-    return body:CreateFixture(fixture_def)
+    return fixture_def
+end
+
+--- Add a fixture to a physics node's body.  The node defers the mass
+-- calculation when called between BeginFixtures and EndFixtures.
+local function AddShapeToNode(node, shape, sensor)
+    local fixture_def = CreateFixtureDef(sensor)
+    fixture_def.shape = shape
+    return node:AddFixture(fixture_def)
 end
 
 local function InitPhysicsNode(node, location, dynamic, tag)
@@ -113,31 +130,57 @@ end
 
 -- Create and initialise a new invisible physics node.
 local function CreatePhysicsNode(location, dynamic, tag)
-    local node = CCPhysicsNode:create()
+    local node = PhysicsNode:create()
     InitPhysicsNode(node, location, dynamic, tag)
     return node
 end
 
-local function DrawBrush(parent, location, color)
-    local child_sprite = CCSprite:createWithTexture(brush_tex)
-    child_sprite:setPosition(location)
-    child_sprite:setColor(color)
-    parent:addChild(child_sprite)
+--- Draw a single dab of the brush at a node relative location.
+local function DrawBrush(node, location, color)
+    if IsHeadless() then
+        return
+    end
+    GetStrokeNode(node):AddPoint(location, color)
 end
 
--- Add a new circle/sphere fixture to a body and return the new fixture
-local function AddSphereToBody(body, location, radius, sensor)
+-- Add a new circle/sphere fixture to a node and return the new fixture
+local function AddSphereToNode(node, location, radius, sensor)
+    local body = node:getB2Body()
     local sphere = b2CircleShape:new_local()
     sphere.m_radius = util.ScreenToWorld(radius)
     sphere.m_p.x = util.ScreenToWorld(location.x) - body:GetPosition().x
     sphere.m_p.y = util.ScreenToWorld(location.y) - body:GetPosition().y
-    return AddShapeToBody(body, sphere, sensor)
+    return AddShapeToNode(node, sphere, sensor)
+end
+
+-- Draw a brush stroke on a node from 'from' to 'to'.  The points are
+-- relative to the node.  Lines that start where the previous one ended
+-- are joined into a single stroke.
+local function DrawStrokeLine(node, from, to, color)
+    if IsHeadless() then
+        return
+    end
+    GetStrokeNode(node):AddLine(from, to, color)
+end
+
+--- Points on a circle around the origin, spaced a brush step apart.
+-- The brush is kept inside 'radius'.
+local function CirclePositions(radius)
+    local inner_radius = math.max(radius - brush_thickness, 1)
+    local circumference = 2 * math.pi * inner_radius
+    local num_points = math.max(math.floor(circumference / brush_step), 3)
+    local positions = {}
+    for i = 0, num_points - 1 do
+        local angle = 2 * math.pi * i / num_points
+        positions[#positions + 1] = ccp(inner_radius * math.cos(angle),
+                                        inner_radius * math.sin(angle))
+    end
+    return positions
 end
 
 -- Add a new line/box fixture to a body and return the new fixture
 local function AddLineToShape(node, from, to, color, absolute)
     -- calculate length and angle of line based on start and end points
-    local body = node:getB2Body()
     local length = ccpDistance(from, to);
     local dist_x = to.x - from.x
     local dist_y = to.y - from.y
@@ -153,25 +196,12 @@ local function AddLineToShape(node, from, to, color, absolute)
     local angle = math.atan2(dist_y, dist_x)
     shape:SetAsBox(util.ScreenToWorld(length/2), util.ScreenToWorld(brush_thickness),
                    center, angle)
-    local fixture = AddShapeToBody(body, shape, false)
-
-    -- Create sequence of sprite nodes as children
-    local dist = CCPointMake(dist_x, dist_y)
-    local num_children = math.ceil(length / brush_step)
-    local inc_x = dist_x / num_children
-    local inc_y = dist_y / num_children
-    local child_location = rel_start
-
-    util.Log('Create line at: rel=' .. util.PointToString(rel_start) .. ' len=' .. length .. ' num=' .. num_children)
-
-    local batch_node = node:getChildByTag(TAG_BATCH_NODE)
-    assert(batch_node)
-    for i = 1,num_children do
-        child_location.x = child_location.x + inc_x
-        child_location.y = child_location.y + inc_y
-        DrawBrush(batch_node, child_location, color)
-    end
+    local fixture = AddShapeToNode(node, shape, false)
+
+    util.Log('Create line at: rel=' .. util.PointToString(rel_start) .. ' len=' .. length)
 
+    local rel_end = ccp(rel_start.x + dist_x, rel_start.y + dist_y)
+    DrawStrokeLine(node, rel_start, rel_end, color)
     return fixture
 end
 
@@ -183,170 +213,112 @@ local function SetCategory(fixture, category)
     fixture:SetFilterData(filter)
 end
 
---- Make the a body dynamic and put it in the default collision group
-local function MakeBodyDynamic(body)
-    body:SetType(b2_dynamicBody)
-    local fixture = body:GetFixtureList()
-    while fixture do
-        SetCategory(fixture, MAIN_CATEGORY)
-        fixture = fixture:GetNext()
-    end
+--- Make the a node's body dynamic and put it in the default collision group
+local function MakeBodyDynamic(node)
+    node:MakeDynamic(MAIN_CATEGORY)
 end
 
---- Set brush texture for subsequent draw operations
-function drawing.SetBrush(brush)
+--- Set the brush batch (a StrokeBatch) used for subsequent draw
+-- operations.  The optional static batch is used for shapes that are
+-- not dynamic.
+function drawing.SetBrush(brush, static_brush)
+    brush_batch = brush
+    static_brush_batch = static_brush
     -- calculate thickness based on brush sprite size
     brush_tex = brush:getTexture()
     local brush_size = brush_tex:getContentSizeInPixels()
-    brush_thickness = math.max(brush_size.height/2, brush_size.width/2)
-    brush_step = brush_thickness * 1.5
+    drawing.SetBrushSize(brush_size.width, brush_size.height)
 end
 
---- Create a physics sprite at a given location with a given image
-local function AddSpriteToShape(node, sprite_def, absolute)
-    local pos = util.PointFromLua(sprite_def.pos, absolute)
-    util.Log('Create sprite [tag=' .. sprite_def.tag .. ' image=' .. sprite_def.image .. ' absolute=' .. tostring(absolute) .. ']: ' ..
-        util.PointToString(pos))
-    local image = game_obj.assets[sprite_def.image]
-    local sprite = CCSprite:create(image)
-    local rel_pos
-    local world_pos
-    if absolute then
-       rel_pos = node:convertToNodeSpace(pos)
-       world_pos = pos
-    else
-       rel_pos = pos
-       world_pos = node:convertToWorldSpace(pos)
-    end
-    sprite:setPosition(rel_pos)
-    node:addChild(sprite)
-    AddSphereToBody(node:getB2Body(), world_pos, sprite:boundingBox().size.height/2, sprite_def.sensor)
-    return sprite
+--- Set the brush size without a texture (used in headless mode).
+function drawing.SetBrushSize(width, height)
+    brush_thickness = math.max(height/2, width/2)
+    brush_step = brush_thickness * 1.5
 end
 
-local function AddChildShape(shape, child_def, absolute)
-    if child_def.color then
-        color = ccc3(child_def.color[1], child_def.color[2], child_def.color[3])
-    else
-        color = ccc3(255, 255, 255)
-    end
-
-    if child_def.type == 'line' then
-        local start = util.PointFromLua(child_def.start, absolute)
-        local finish = util.PointFromLua(child_def.finish, absolute)
-        AddLineToShape(shape, start, finish, color, absolute)
-    elseif child_def.type == 'image' then
-        AddSpriteToShape(shape, child_def, absolute)
-    else
-        assert(false, 'invalid shape type: ' .. shape_def.type)
-    end
+--- Return the options passed to the levelbuilder module, which builds
+-- shapes natively using the same constants as the rest of this file.
+local function BuilderOptions()
+    return {
+        ptm_ratio = util.PTM_RATIO,
+        stroke_tag = TAG_STROKE_NODE,
+        material = MATERIAL,
+        headless = IsHeadless(),
+        brush = brush_batch,
+        static_brush = static_brush_batch,
+        brush_thickness = brush_thickness,
+        assets = game_obj.assets,
+        image_size = util.GetPngSize,
+    }
 end
 
---- Draw a shape described by a given shape def.
+--- Draw a shape described by a given shape def, which must have a tag.
 -- This creates physics sprites and accosiated box2d bodies for
--- the shape.
+-- the shape.  Returns the shape's node (edges have none).
 function drawing.CreateShape(shape_def)
-    local shape = nil
-
-    if shape_def.type == 'compound' then
-        local pos = util.PointFromLua(shape_def.pos)
-        shape = CreatePhysicsNode(pos, shape_def.dynamic, shape_def.tag)
-        CreateBrushBatch(shape)
-        if shape_def.children then
-            for _, child_def in ipairs(shape_def.children) do
-                child_def.tag = shape_def.tag
-                child = AddChildShape(shape, child_def, false)
-            end
-        end
-    elseif shape_def.type == 'line' then
-        local pos = util.PointFromLua(shape_def.start)
-        shape = CreatePhysicsNode(pos, shape_def.dynamic, shape_def.tag)
-        CreateBrushBatch(shape)
-        AddChildShape(shape, shape_def, true)
-    elseif shape_def.type == 'edge' then
-        local body_def = b2BodyDef:new_local()
-        local body = level_obj.world:CreateBody(body_def)
-        local b2shape = b2EdgeShape:new_local()
-        local start = b2VecFromLua(shape_def.start)
-        local finish = b2VecFromLua(shape_def.finish)
-        util.Log('Create edge from: ' .. util.VecToString(start) .. ' to: ' .. util.VecToString(finish))
-        b2shape:Set(start, finish)
-        body:CreateFixture(b2shape, 0)
-        return
-    elseif shape_def.type == 'image' then
-        local pos = util.PointFromLua(shape_def.pos)
-        shape = CreatePhysicsNode(pos, shape_def.dynamic, shape_def.tag)
-        AddChildShape(shape, shape_def, true)
-    else
-        assert(false, 'invalid shape type: ' .. shape_def.type)
-    end
-
-    if shape_def.anchor then
-        local body = shape:getB2Body()
-        local anchor = util.PointFromLua(shape_def.anchor)
-        CreatePivot(anchor, body)
-    end
+    return levelbuilder.create_shape(level_obj.layer, shape_def, BuilderOptions())
+end
 
-    return shape
+--- Create all the shapes in a (possibly nested) list of shape defs.
+-- The shapes are built natively by the levelbuilder module in a single
+-- call, with the same results as calling CreateShape for each of them.
+-- Each shape def is given a tag (counting up from 'first_tag'), a
+-- tag_str and a node.  Returns a map from tag strings to tags and the
+-- list of shape defs in tag order.
+function drawing.CreateShapes(shapes, first_tag)
+    local options = BuilderOptions()
+    options.first_tag = first_tag
+    return levelbuilder.build(level_obj.layer, shapes, options)
 end
 
 --- Create a single circlular point with the brush.
 -- This is used to start shapes that the user draws.  The returned
 -- node is the an invisible node that acts as the physics objects.
--- Sprite nodes are then attached to this as the user draws.
+-- The stroke is then extended as the user draws.
 function drawing.DrawStartPoint(location, color, tag, dynamic)
     -- Add invisibe physics node
     local node = CreatePhysicsNode(location, dynamic, tag)
-    CreateBrushBatch(node)
+    CreateStrokeNode(node)
 
     -- Add visible sprite
-    local sprite = CCSprite:createWithTexture(brush_tex)
-    sprite:setColor(color)
-    node:addChild(sprite)
+    DrawBrush(node, ccp(0, 0), color)
 
     -- Add collision info
-    local fixture = AddSphereToBody(node:getB2Body(), location, brush_thickness, false)
+    local fixture = AddSphereToNode(node, location, brush_thickness, false)
     SetCategory(fixture, DRAWING_CATEGORY)
 
     return node
 end
 
---- Create a circle composed of brush sprites backed by a single box2d
--- circle fixture.
+--- Create a circle drawn as a closed brush stroke backed by a single
+-- box2d circle fixture.
 function drawing.DrawCircle(center, radius, color, tag)
     -- Create the initial (invisible) node at the center
-    -- and then attach a sequence of visible child sprites
+    -- and then attach the visible stroke
     local node = CreatePhysicsNode(center, true, tag)
-    local batch_node = CreateBrushBatch(node)
+    local stroke = CreateStrokeNode(node)
 
-    local inner_radius = math.max(radius - brush_thickness, 1)
-    local circumference = 2 * math.pi * inner_radius
-    local num_sprites = math.max(circumference / brush_step, 1)
-    local angle_delta = 2 * math.pi / num_sprites
-
-    util.Log('drawing circle: radius=' .. math.floor(radius) .. ' sprites=' .. math.floor(num_sprites))
-    for angle = 0, 2 * math.pi, angle_delta do
-        x = inner_radius * math.cos(angle)
-        y = inner_radius * math.sin(angle)
-        DrawBrush(batch_node, ccp(x, y), color)
+    local positions = CirclePositions(radius)
+    util.Log('drawing circle: radius=' .. math.floor(radius) .. ' points=' .. #positions)
+    if stroke then
+        for _, pos in ipairs(positions) do
+            stroke:AddPoint(pos, color)
+        end
+        stroke:ClosePolyline()
     end
 
     -- Create the box2d physics body to match the sphere.
-    local fixture = AddSphereToBody(node:getB2Body(), center, radius, false)
+    local fixture = AddSphereToNode(node, center, radius, false)
     SetCategory(fixture, DRAWING_CATEGORY)
     return node
 end
 
 function drawing.DrawEndPoint(node, location, color)
     -- Add visible sprite
-    local child_sprite = CCSprite:createWithTexture(brush_tex)
-    child_sprite:setPosition(node:convertToNodeSpace(location))
-    child_sprite:setColor(color)
-    node:addChild(child_sprite)
+    DrawBrush(node, node:convertToNodeSpace(location), color)
 
     -- Add collision info
-    local body = node:getB2Body()
-    local fixture = AddSphereToBody(body, location, brush_thickness, false)
+    local fixture = AddSphereToNode(node, location, brush_thickness, false)
     SetCategory(fixture, DRAWING_CATEGORY)
 end
 
@@ -355,6 +327,62 @@ function drawing.AddLineToShape(sprite, from, to, color)
     SetCategory(fixture, DRAWING_CATEGORY)
 end
 
+--- Extend a freehand stroke to 'to'.  Only the brush stroke is drawn
+-- here; the physics fixtures for the whole stroke are created by
+-- FinishStroke.
+function drawing.AddLineToStroke(node, from, to, color)
+    DrawStrokeLine(node, node:convertToNodeSpace(from),
+                   node:convertToNodeSpace(to), color)
+    node:AddStrokePoint(to)
+end
+
+--- Create the fixtures for a freehand stroke.  The stroke is simplified
+-- first so that long strokes don't end up with hundreds of fixtures.
+-- Strokes that end near their start are filled in to make a solid
+-- shape.
+function drawing.FinishStroke(node)
+    local fixture_def = CreateFixtureDef(false)
+    local tolerance = brush_thickness * STROKE_TOLERANCE
+    local count = node:FinishStroke(fixture_def, brush_thickness, tolerance)
+    util.Log('stroke created with ' .. count .. ' fixtures')
+end
+
+--- Create the preview node shown while a line or circle is dragged out.
+-- The preview is just a brush stroke with no physics body; the body is
+-- created once the touch ends.  Returns nil in headless mode.
+local function CreatePreview(location)
+    if IsHeadless() then
+        return nil
+    end
+    local node = StrokeNode:create(brush_tex, brush_thickness)
+    node:setPosition(location)
+    level_obj.layer:addChild(node, 1)
+    return node
+end
+
+--- Redraw the preview stroke through the given node relative
+-- positions.  The same node is reused for every move.
+local function UpdatePreview(node, positions, color, closed)
+    if not node then
+        return
+    end
+
+    node:Clear()
+    for _, pos in ipairs(positions) do
+        node:AddPoint(pos, color)
+    end
+    if closed then
+        node:ClosePolyline()
+    end
+end
+
+local function RemovePreview(shape)
+    if shape.preview then
+        shape.preview:removeFromParentAndCleanup(true)
+        shape.preview = nil
+    end
+end
+
 function drawing.IsDrawing()
    return current_shape ~= nil
 end
@@ -381,11 +409,16 @@ function drawing.OnTouchBegan(x, y)
         script = drawing.handlers,
     }
 
-    if drawing.mode == drawing.MODE_FREEHAND or drawing.mode == drawing.MODE_LINE then
+    if drawing.mode == drawing.MODE_FREEHAND then
         -- create initial sphere to represent start of shape
         shape.node = drawing.DrawStartPoint(start_pos, brush_color, current_tag)
+        shape.node:AddStrokePoint(start_pos)
+    elseif drawing.mode == drawing.MODE_LINE then
+        shape.preview = CreatePreview(start_pos)
+        UpdatePreview(shape.preview, { ccp(0, 0) }, brush_color)
     elseif drawing.mode == drawing.MODE_CIRCLE then
-        shape.node = drawing.DrawCircle(start_pos, 1, brush_color, current_tag)
+        shape.preview = CreatePreview(start_pos)
+        UpdatePreview(shape.preview, CirclePositions(1), brush_color, true)
     else
         error('invalid drawing mode: ' .. tostring(drawing.mode))
     end
@@ -414,20 +447,15 @@ function drawing.OnTouchMoved(x, y)
         -- Draw line segments as the touch moves
         local length = ccpDistance(new_pos, last_pos);
         if length > brush_thickness * 2 then
-            drawing.AddLineToShape(current_shape.node, last_pos, new_pos, brush_color)
+            drawing.AddLineToStroke(current_shape.node, last_pos, new_pos, brush_color)
             last_pos = new_pos
         end
     elseif drawing.mode == drawing.MODE_LINE then
-        local tag = current_shape.node:getTag()
-        drawing.DestroySprite(current_shape.node)
-
-        current_shape.node = drawing.DrawStartPoint(start_pos, brush_color, tag)
-        drawing.AddLineToShape(current_shape.node, start_pos, new_pos, brush_color)
+        local delta = ccp(new_pos.x - start_pos.x, new_pos.y - start_pos.y)
+        UpdatePreview(current_shape.preview, { ccp(0, 0), delta }, brush_color)
     elseif drawing.mode == drawing.MODE_CIRCLE then
-        local tag = current_shape.node:getTag()
-        drawing.DestroySprite(current_shape.node)
-        radius = ccpDistance(start_pos, new_pos)
-        current_shape.node = drawing.DrawCircle(start_pos, radius, brush_color, tag)
+        local radius = ccpDistance(start_pos, new_pos)
+        UpdatePreview(current_shape.preview, CirclePositions(radius), brush_color, true)
     else
         error('invalid drawing mode: ' .. tostring(drawing.mode))
     end
@@ -442,16 +470,28 @@ function drawing.OnTouchEnded(x, y)
         new_pos = ccp(x, y)
         local length = ccpDistance(new_pos, last_pos);
         if length > brush_thickness then
-            drawing.AddLineToShape(current_shape.node, last_pos, new_pos, brush_color)
+            drawing.AddLineToStroke(current_shape.node, last_pos, new_pos, brush_color)
         end
+        drawing.FinishStroke(current_shape.node)
         drawing.DrawEndPoint(current_shape.node, new_pos, brush_color)
-    elseif drawing.mode == drawing.MODE_CIRCLE or drawing.mode == drawing.MODE_LINE then
-        --
+    elseif drawing.mode == drawing.MODE_LINE then
+        -- Replace the preview with the real shape
+        new_pos = ccp(x, y)
+        RemovePreview(current_shape)
+        current_shape.node = drawing.DrawStartPoint(start_pos, brush_color, current_shape.tag)
+        if ccpDistance(start_pos, new_pos) > 0 then
+            drawing.AddLineToShape(current_shape.node, start_pos, new_pos, brush_color)
+        end
+    elseif drawing.mode == drawing.MODE_CIRCLE then
+        new_pos = ccp(x, y)
+        RemovePreview(current_shape)
+        local radius = math.max(ccpDistance(start_pos, new_pos), 1)
+        current_shape.node = drawing.DrawCircle(start_pos, radius, brush_color, current_shape.tag)
     else
         error('invalid drawing mode: ' .. tostring(drawing.mode))
     end
 
-    MakeBodyDynamic(current_shape.node:getB2Body())
+    MakeBodyDynamic(current_shape.node)
 
     local rtn = current_shape
     last_pos = nil
@@ -11,8 +11,6 @@ local drawing = require 'drawing'
 local editor = {}
 
 local MENU_DRAW_ORDER = 3
-local VELOCITY_ITERATIONS = 8
-local POS_ITERATIONS = 1
 
 local actions = { ADD_SHAPE = 1, MOVE = 2 }
 local undo_buffer = {}
@@ -31,12 +29,6 @@ local function SerializeLevel()
     return '# Automatically generated by editor.lua\n\n' .. output
 end
 
-function editor.Update(delta)
-    if level_obj.run_physics then
-      level_obj.world:Step(delta, VELOCITY_ITERATIONS, POS_ITERATIONS)
-    end
-end
-
 function editor.OnTouchBegan(x, y, tapcount)
     if drawing.IsDrawing() then
         return false
@@ -157,7 +149,8 @@ local function ToggleDebug()
 end
 
 local function ToggleRun()
-    level_obj.run_physics = not level_obj.run_physics
+    local layer = level_obj.layer
+    layer:SetPhysicsEnabled(not layer:IsPhysicsEnabled())
 end
 
 local function HandleRestart()
@@ -170,7 +163,7 @@ end
 
 function editor.StartLevel(level_number)
     -- Create a textual menu it its own layer as a sibling of the LevelLayer
-    level_obj.run_physics = false
+    level_obj.layer:SetPhysicsEnabled(false)
     menu_def = {
         font_size = 24,
         align = 'Left',
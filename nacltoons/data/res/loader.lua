@@ -7,6 +7,7 @@
 -- startup:
 --  - LoadGame  (called my game_manager to load game.def)
 --  - LoadLevel  (called by level_layer to load a level)
+--  - OnContacts  (called by level_layer after each physics update)
 --
 -- There are also 3 functions for which the game can define its own
 -- handlers:
@@ -30,18 +31,32 @@ game_obj = nil
 -- The currently loaded level (set by LoadLevel)
 level_obj = nil
 
+-- Parsed and validated level defs keyed by filename, so that restarting
+-- or revisiting a level doesn't read and parse it again.  Each entry
+-- holds the stamp of the file it was loaded from (see util.DefStamp).
+local level_cache = {}
+local level_cache_hits = 0
+local level_cache_misses = 0
+
 --- Load game def from the given filename.  This function loads
 -- the game.def file which is essentailly a dictionary and performs
 -- a bit of post-processing on it.
-local function LoadGameDef(filename)
+local function LoadGameDef(filename, headless)
     Log('loading gamedef: '..filename)
-    local game = util.LoadYaml(filename)
+    local game = util.LoadDef(filename)
     game.root = path.dirname(filename)
+    -- Even compiled game defs are validated since validation is what
+    -- resolves the asset paths.
     validate.ValidateGameDef(filename, game)
     Log('found ' .. #game.levels .. ' level(s)')
     game.filename = filename
+    game.headless = headless
 
-    if game.script then
+    if headless then
+        -- Game scripts drive menus and other UI which cannot be created
+        -- without a GL context, so only the physics is simulated.
+        game.script = {}
+    elseif game.script then
         Log('loading game script: ' .. game.script)
         game.script = dofile(path.join(game.root, game.script))
     end
@@ -49,6 +64,20 @@ local function LoadGameDef(filename)
     return game
 end
 
+--- Returns true if a script defines a contact handler.
+local function HasContactHandlers(script)
+    return script and (script.OnContactBegan or script.OnContactEnded)
+end
+
+--- If the game restricted the contacts it wants to hear about then make
+-- sure that an object with its own contact handlers still gets them.
+local function SubscribeContacts(tag, object)
+    local layer = level_obj.layer
+    if layer:HasContactFilters() and HasContactHandlers(object.script) then
+        layer:AddContactFilter(tag, 0)
+    end
+end
+
 function RegisterObject(object, tag, tag_str)
     level_obj.tag_list[tag] = tag_str
     assert(level_obj.object_map[tag] == nil, 'object_map already contains ' .. tag)
@@ -58,23 +87,15 @@ function RegisterObject(object, tag, tag_str)
         assert(level_obj.tag_map[tag_str] == nil, 'duplicate object tag: ' .. tag_str)
         level_obj.tag_map[tag_str] = tag
     end
+    SubscribeContacts(tag, object)
     if not tag_str then tag_str = '' end
     Log('object registered: ' .. tag .. " = '" .. tag_str .. "'")
 end
 
-local function RegisterObjectDef(object)
-    local new_tag = #level_obj.tag_list + 1
-    if object.tag then
-        object.tag_str = object.tag
-    else
-        object.tag_str = tostring(new_tag)
-    end
-
-    object.tag = new_tag
-    RegisterObject(object, object.tag, object.tag_str)
-end
-
 local function LoadScript(obj_def)
+    if game_obj.headless then
+        return
+    end
     if obj_def.script and game_obj.game_mode ~= "edit" then
         Log('loading object script: ' .. obj_def.script)
         local script = path.join(game_obj.root, obj_def.script)
@@ -88,10 +109,15 @@ end
 --- Load game data from a given root directory.
 -- This game then becomes the currently running game.
 -- @param The root directory of the game to be loaded.
-function LoadGame(root_dir)
+-- @param headless When true only load what is needed to simulate levels.
+function LoadGame(root_dir, headless)
    game_root = root_dir
-   game_obj = LoadGameDef(path.join(game_root, 'game.def'))
+   game_obj = LoadGameDef(path.join(game_root, 'game.def'), headless)
    game_obj.origin = CCDirector:sharedDirector():getVisibleOrigin()
+   if headless then
+       return
+   end
+
    local default_game
 
    if not game_obj.script or not game_obj.script.StartGame then
@@ -132,6 +158,41 @@ local function GameUpdate(delta)
     end
 end
 
+--- Load and validate a level def, or take it from the level cache if
+-- the file hasn't changed since it was cached.  The level def is
+-- modified as the level is built so callers always get their own copy
+-- and the cached one is never handed out.
+-- @param name the level's filename relative to the game root
+local function LoadLevelDef(name)
+    local filename = path.join(game_obj.root, name)
+    local stamp = util.DefStamp(filename)
+    local entry = level_cache[filename]
+    if entry and stamp and entry.stamp == stamp then
+        level_cache_hits = level_cache_hits + 1
+        return util.DeepCopy(entry.leveldef)
+    end
+    level_cache[filename] = nil
+
+    level_cache_misses = level_cache_misses + 1
+    local leveldef, compiled = util.LoadDef(filename)
+    -- Compiled levels were validated when they were compiled, and the
+    -- native validator records the files that it has checked.
+    if not compiled and not validate.IsValidated(game_obj.root, name) then
+        validate.ValidateLevelDef(filename, game_obj, leveldef)
+    end
+    if not stamp then
+        return leveldef
+    end
+    level_cache[filename] = { stamp = stamp, leveldef = leveldef }
+    return util.DeepCopy(leveldef)
+end
+
+--- Return the number of level loads that were served from the level
+-- cache and the number that had to read the level from disk.
+function GetLevelCacheStats()
+    return level_cache_hits, level_cache_misses
+end
+
 --- Load the given level of the given game
 -- @param layer The level to populate with game objects
 -- @param level_number The level to load
@@ -140,10 +201,7 @@ function LoadLevel(layer, level_number)
     -- Get level descrition object
     assert(level_number <= #game_obj.levels and level_number > 0,
            'Invalid level number: ' .. level_number)
-    local filename = path.join(game_obj.root, game_obj.levels[level_number])
-    level_obj = util.LoadYaml(filename)
-
-    validate.ValidateLevelDef(filename, game_obj, level_obj)
+    level_obj = LoadLevelDef(game_obj.levels[level_number])
 
     LevelInit()
     level_obj.layer = layer
@@ -152,38 +210,55 @@ function LoadLevel(layer, level_number)
     local assets = game_obj.assets
 
     -- Load brush image
-    level_obj.brush = CCSpriteBatchNode:create(assets.brush_image, 500)
-    layer:addChild(level_obj.brush, 1)
-    drawing.SetBrush(level_obj.brush)
+    if game_obj.headless then
+        drawing.SetBrushSize(util.GetPngSize(assets.brush_image))
+    else
+        -- All drawn strokes share a single batch so they are drawn
+        -- with one draw call.  Strokes of the shapes that are drawn
+        -- into the layer's static cache have a batch of their own.
+        local texture = CCTextureCache:sharedTextureCache():addImage(assets.brush_image)
+        level_obj.brush = StrokeBatch:create(texture)
+        layer:addChild(level_obj.brush, 1)
+        level_obj.static_brush = StrokeBatch:create(texture)
+        layer:addChild(level_obj.static_brush, 1)
+        layer:AddStaticNode(level_obj.static_brush)
+        drawing.SetBrush(level_obj.brush, level_obj.static_brush)
+    end
 
     -- Start music playback
-    if game_obj.assets.music then
+    if game_obj.assets.music and not game_obj.headless then
         SimpleAudioEngine:sharedEngine():playBackgroundMusic(game_obj.assets.music, true)
     end
 
     -- Load background image
-    if game_obj.assets.background_image then
+    if game_obj.assets.background_image and not game_obj.headless then
         local winsize = CCDirector:sharedDirector():getWinSize()
         local sprite = CCSprite:create(game_obj.assets.background_image)
         sprite:setPosition(ccp(winsize.width/2, winsize.height/2))
         layer:addChild(sprite)
+        layer:AddStaticNode(sprite)
     end
 
-    -- Load shapes
-    local function LoadShapes(shapes)
-        for _, shape_def in ipairs(shapes) do
-            if #shape_def > 0 then
-                LoadShapes(shape_def)
-            else
-                RegisterObjectDef(shape_def)
-                shape_def.node = drawing.CreateShape(shape_def)
-                LoadScript(shape_def)
-            end
+    -- Load shapes.  The bodies, sprites and strokes of all the shapes
+    -- are created natively in one call.
+    if level_obj.shapes then
+        local tag_map, objects = drawing.CreateShapes(level_obj.shapes, #level_obj.tag_list + 1)
+        level_obj.tag_map = tag_map
+        for _, shape_def in ipairs(objects) do
+            level_obj.tag_list[shape_def.tag] = shape_def.tag_str
+            level_obj.object_map[shape_def.tag] = shape_def
+            LoadScript(shape_def)
         end
     end
 
-    if level_obj.shapes then
-        LoadShapes(level_obj.shapes)
+    -- Levels larger than the screen scroll to follow the camera target.
+    if level_obj.size then
+        layer:SetLevelBounds(0, 0, level_obj.size[1], level_obj.size[2])
+    end
+    if level_obj.camera and not game_obj.headless then
+        local tag = level_obj.tag_map[level_obj.camera]
+        assert(tag, 'camera target not found: ' .. level_obj.camera)
+        layer:SetCameraTarget(level_obj.object_map[tag].node)
     end
 
     -- Load custom level script
@@ -194,7 +269,9 @@ function LoadLevel(layer, level_number)
         level_obj.layer:scheduleUpdateWithPriorityLua(GameUpdate, 0)
     end
 
-    layer:registerScriptTouchHandler(touch_handler.TouchHandler)
+    if not game_obj.headless then
+        layer:registerScriptTouchHandler(touch_handler.TouchHandler)
+    end
     StartLevel(level_number)
 end
 
@@ -247,12 +324,27 @@ local function CallCollisionHandler(tag1, tag2, handler_name)
     end
 end
 
-function OnContactBegan(tag1, tag2)
-    CallCollisionHandler(tag1, tag2, 'OnContactBegan')
-end
-
-function OnContactEnded(tag1, tag2)
-    CallCollisionHandler(tag1, tag2, 'OnContactEnded')
+-- Contact kinds used by LevelLayer when reporting contacts.
+local CONTACT_BEGAN = 1
+local CONTACT_ENDED = 2
+
+local contact_handler_names = {
+    [CONTACT_BEGAN] = 'OnContactBegan',
+    [CONTACT_ENDED] = 'OnContactEnded',
+}
+
+-- Called by the level_layer once per physics update with all the
+-- contacts that started or finished during the update.  'contacts'
+-- is a flat array of (tag1, tag2, kind) triples.
+function OnContacts(contacts)
+    for i = 1, #contacts, 3 do
+        -- A handler may have completed the level.
+        if level_obj == nil then
+            return
+        end
+        local handler_name = contact_handler_names[contacts[i + 2]]
+        CallCollisionHandler(contacts[i], contacts[i + 1], handler_name)
+    end
 end
 
 function StartLevel(level_number)
@@ -261,4 +353,19 @@ function StartLevel(level_number)
     if game_obj.script.StartLevel then
         game_obj.script.StartLevel(level_number)
     end
+
+    -- If the game added contact filters then subscribe the objects that
+    -- handle contacts themselves.  The level script's handlers are
+    -- called for contacts between any two objects so they need every
+    -- contact.
+    local layer = level_obj.layer
+    if not layer:HasContactFilters() then
+        return
+    end
+    if HasContactHandlers(level_obj.script) then
+        layer:AddContactFilter(0, 0)
+    end
+    for tag, object in pairs(level_obj.object_map) do
+        SubscribeContacts(tag, object)
+    end
 end
@@ -28,8 +28,6 @@ local handlers = {}
 local MENU_DRAW_ORDER = 3
 local FONT_NAME = 'Arial.ttf'
 local FONT_SIZE = 32
-local VELOCITY_ITERATIONS = 8
-local POS_ITERATIONS = 1
 
 
 --- Menu callback
@@ -59,9 +57,6 @@ end
 --- Game behaviour callback.  Called every frame with the time delta
 -- in seconds since the previous frame.
 function handlers.Update(delta)
-    -- Update box2d world
-    level_obj.world:Step(delta, VELOCITY_ITERATIONS, POS_ITERATIONS)
-
     -- Check for timeout
     local state = level_obj.game_state
     state.time_remaining = state.time_remaining - delta
@@ -98,6 +93,13 @@ function handlers.StartLevel(level_number)
     level_obj.goal_tag = level_obj.tag_map['GOAL']
     level_obj.star_tag = level_obj.tag_map['STAR1']
 
+    -- Only collisions involving the ball are handled below so don't
+    -- have the engine report any others.  A nil tag would reach the
+    -- layer as zero, which matches every contact.
+    if level_obj.ball_tag then
+        level_obj.layer:AddContactFilter(level_obj.ball_tag, 0)
+    end
+
     -- Create a textual menu as a sibling of the LevelLayer
     menu_def = {
         font_size = 24,
@@ -115,20 +117,23 @@ function handlers.StartLevel(level_number)
     parent:addChild(menu, MENU_DRAW_ORDER)
 
     -- Create time display
+    -- Like the menu this is a sibling of the LevelLayer so that it
+    -- stays put when the level scrolls.
     level_obj.time_display = CCLabelTTF:create("--", FONT_NAME, FONT_SIZE)
-    level_obj.layer:addChild(level_obj.time_display)
+    parent:addChild(level_obj.time_display, MENU_DRAW_ORDER)
     PositionTimer(level_obj.time_display)
 end
 
 --- Remove a shape that was previously draw by this drawing module.
 function drawing.RemoveShape(tag)
-    local sprite = level_obj.brush:getChildByTag(tag)
+    local node = level_obj.layer:getChildByTag(tag)
     -- Remove the box2d body
-    sprite = tolua.cast(sprite, "CCPhysicsSprite")
-    local body = sprite:getB2Body()
+    node = tolua.cast(node, "PhysicsNode")
+    local body = node:getB2Body()
     level_obj.world:DestroyBody(body)
-    -- Remove the sprite from the brush (its parent)
-    level_obj.brush:removeChild(sprite, true)
+    -- Remove the node from the layer.  Its strokes leave the brush
+    -- batch along with it.
+    level_obj.layer:removeChild(node, true)
 end
 
 local last_drawn_shape = nil
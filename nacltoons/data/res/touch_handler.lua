@@ -20,26 +20,22 @@ local touch_state = {
 local function FindTaggedBodiesAt(x, y)
     local b2pos = util.b2VecFromCocos(ccp(x, y))
     local found_bodies = {}
-    local found_something = false
-    local function handler(body)
-        found_something = true
-        local tag = body:GetUserData()
-        if tag ~= 0 then
-            -- FindBodiesAt can report the same bodies more than
-            -- once since it reports the body for each fixture that
-            -- exists at a given point, so filter out duplicates here.
-            if not found_bodies[tag] then
+    local function handler(bodies)
+        -- Each body is reported once no matter how many of its
+        -- fixtures contain the point.
+        for _, body in ipairs(bodies) do
+            local tag = body:GetUserData()
+            if tag ~= 0 then
                 util.Log("found body.. " .. tag)
                 assert(level_obj.object_map[tag])
                 found_bodies[tag] = level_obj.object_map[tag]
+            else
+                util.Log("Found untagged body")
             end
         end
     end
 
-    level_obj.layer:FindBodiesAt(b2pos, handler)
-    if found_something and #found_bodies == 0 then
-        util.Log("Found untagged bodies")
-    end
+    level_obj.layer:QueryPoint(b2pos, handler)
     return found_bodies
 end
 
@@ -139,6 +135,11 @@ local function OnTouchEnded(x, y, touchid)
 end
 
 function touch_handler.TouchHandler(touch_type, x, y, touchid)
+    -- Touches arrive in screen coordinates; convert them to level
+    -- coordinates in case the camera has scrolled the layer.
+    local pos = level_obj.layer:convertToNodeSpace(ccp(x, y))
+    x = pos.x
+    y = pos.y
     if touch_type == 'began' then
         return OnTouchBegan(x, y, touchid)
     elseif touch_type == 'moved' then
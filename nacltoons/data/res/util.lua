@@ -56,13 +56,88 @@ function util.b2VecFromCocos(cocos_vec)
                             util.ScreenToWorld(cocos_vec.y))
 end
 
+--- Return the width and height of a PNG image.  Only the image header
+-- is read, so this works without a GL context (unlike CCSprite).
+function util.GetPngSize(filename)
+    local f = assert(io.open(filename, 'rb'))
+    local header = f:read(24)
+    f:close()
+    assert(header and #header == 24 and header:sub(2, 4) == 'PNG',
+           'not a PNG file: ' .. filename)
+    local function ReadInt32(offset)
+        local b1, b2, b3, b4 = header:byte(offset, offset + 3)
+        return ((b1 * 256 + b2) * 256 + b3) * 256 + b4
+    end
+    return ReadInt32(17), ReadInt32(21)
+end
+
 --- Load a yaml file and return a lua table that represents the data
--- in the file.
+-- in the file.  Where the yamlfile module is available (i.e. in the
+-- game itself) the file is streamed through libyaml rather than read
+-- into a string first.
 function util.LoadYaml(filename)
+    if yamlfile then
+        return yamlfile.load(filename)
+    end
     local filedata = io.open(filename, "r"):read("*all")
     return yaml.load(filedata)
 end
 
+--- Return the name of the compiled version of a .def file (see
+-- compile.lua).
+function util.CompiledFilename(filename)
+    return (filename:gsub('%.def$', '') .. '.bin')
+end
+
+--- Return a value that changes whenever the given .def file or its
+-- compiled version changes, or nil if this can't be determined (i.e.
+-- outside of the game, where the levelfile module isn't available).
+function util.DefStamp(filename)
+    if not levelfile then
+        return nil
+    end
+    local compiled = util.CompiledFilename(filename)
+    return tostring(levelfile.stamp(filename)) .. '/' .. tostring(levelfile.stamp(compiled))
+end
+
+--- Load a .def file and return a lua table that represents the data
+-- in the file.  When the file has been compiled and the .def file is
+-- unchanged since (the compiled file records its size and checksum)
+-- the compiled version is loaded, which avoids parsing yaml.  The
+-- second return value is true in this case.  Compiled files can only
+-- be loaded where the levelfile module is available (i.e. in the game
+-- itself).
+function util.LoadDef(filename)
+    if levelfile then
+        local compiled = util.CompiledFilename(filename)
+        if levelfile.mtime(compiled) then
+            local data = levelfile.load(compiled, filename)
+            if data then
+                return data, true
+            end
+        end
+    end
+    return util.LoadYaml(filename), false
+end
+
+--- Return a copy of a value in which all tables are copied too.
+-- Tables that appear more than once in the original are copied once.
+function util.DeepCopy(value, copies)
+    if type(value) ~= 'table' then
+        return value
+    end
+    copies = copies or {}
+    if copies[value] then
+        return copies[value]
+    end
+    local copy = {}
+    copies[value] = copy
+    for key, element in pairs(value) do
+        copy[util.DeepCopy(key, copies)] = util.DeepCopy(element, copies)
+    end
+    return setmetatable(copy, getmetatable(value))
+end
+
 --- Escape string for inclusion in yaml output.  Normal strings
 -- that contain no special characters don't even need quoting in
 -- in yaml.  This function adds quotes and escape chars as needed.
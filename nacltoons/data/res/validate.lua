@@ -4,12 +4,17 @@
 
 -- Functions for validating game data files (.def files).
 -- This module provides a single global called 'validate' which
--- contains two function:
+-- contains three functions:
 --   ValidateGameDef
 --   ValidateLevelDef
+--   IsValidated
 --
 -- It is possible to run this code a game.def file from the command line:
 -- $ ./lua.sh ./data/res/validate.lua data/res/sample_game/game.def
+--
+-- The same schema is compiled into the native validator in tools/,
+-- which can check every game under a directory in parallel.  The two
+-- must be kept in sync.
 
 local path = require 'path'
 local util = require 'util'
@@ -19,26 +24,47 @@ local function Error(filename, message)
     assert(false, "Error in '" .. filename .. "':" ..  message)
 end
 
---- Return true if a list contains a given element, false otherwise
-local function ListContains(list, element)
-  for _, value in ipairs(list) do
-      if value == element then
-          return true
-      end
-  end
-  return false
+--- Return a set containing the elements of a list, so that
+-- membership can be checked with a single table lookup.
+local function Set(list)
+    local set = {}
+    for _, element in ipairs(list) do
+        set[element] = true
+    end
+    return set
 end
 
---- Check that all the keys in the given object are in the list
+local GAME_KEYS = Set{ 'assets', 'script', 'levels', 'root' }
+local LEVEL_KEYS = Set{ 'num_stars', 'shapes', 'script', 'size', 'camera' }
+local SHAPE_KEYS = Set{ 'script', 'pos', 'children', 'sensor', 'image', 'start', 'finish', 'color', 'type', 'anchor', 'tag', 'dynamic' }
+local SHAPE_TYPES = Set{ 'compound', 'line', 'edge', 'image' }
+
+-- File written by the native validator (tools/validate_defs -w) next to
+-- game.def, listing the files that passed along with their modification
+-- times.
+local STAMP_FILE = 'validated.stamp'
+local STAMP_HEADER = 'nacltoons validated 1'
+
+--- Check that all the keys in the given object are in the set
 -- of valid keys.
 local function CheckValidKeys(filename, object, valid_keys)
     for key, _ in pairs(object) do
-        if not ListContains(valid_keys, key) then
+        if not valid_keys[key] then
             return Error(filename, 'invalid key: ' .. key)
         end
     end
 end
 
+--- Return true if a table is a list, i.e. its only keys are 1..n.
+-- Empty tables count as lists since yaml's [] and {} both load as one.
+local function IsList(object)
+    local count = 0
+    for _ in pairs(object) do
+        count = count + 1
+    end
+    return count == #object
+end
+
 local function CheckRequiredKeys(filename, object, required_keys, name)
     for _, required in ipairs(required_keys) do
         if object[required] == nil then
@@ -62,20 +88,38 @@ validate.ValidateGameDef = function(filename, gamedef)
     end
 
 
-    CheckValidKeys(filename, gamedef, { 'assets', 'script', 'levels', 'root' })
+    CheckValidKeys(filename, gamedef, GAME_KEYS)
+
+    if gamedef.levels then
+        if type(gamedef.levels) ~= 'table' or not IsList(gamedef.levels) then
+            Err('levels must be a list of filenames')
+        end
+        for _, level in ipairs(gamedef.levels) do
+            if type(level) == 'table' then
+                Err('level must be a filename')
+            end
+        end
+    end
+
     if not gamedef.assets then
         return
     end
+    if type(gamedef.assets) ~= 'table' then
+        return Err('assets must be a table')
+    end
 
     CheckRequiredKeys(filename, gamedef.assets, { 'level_icon', 'level_icon_selected' }, 'asset list')
 
     for asset_name, asset_file in pairs(gamedef.assets) do
+        if type(asset_file) == 'table' then
+            Err('asset must be a filename')
+        end
         local fullname = path.join(gamedef.root, asset_file)
         local f = io.open(fullname, 'r')
         if f ~= nil then
             io.close(f)
         else
-            Err('asset does not exist: ' .. gamedef.asset_name)
+            Err('asset does not exist: ' .. asset_file)
         end
         gamedef.assets[asset_name] = fullname
     end
@@ -93,22 +137,35 @@ validate.ValidateLevelDef = function(filename, gamedef, leveldef)
         return Err("file does not evaluate to an object of type 'table'")
     end
 
-    CheckValidKeys(filename, leveldef, { 'num_stars', 'shapes', 'script' })
+    CheckValidKeys(filename, leveldef, LEVEL_KEYS)
+
+    if leveldef.size then
+        local size = leveldef.size
+        if type(size) ~= 'table' or not IsList(size) or #size ~= 2 or type(size[1]) ~= 'number' or type(size[2]) ~= 'number' then
+            Err('size must be a list of two numbers')
+        end
+    end
 
     if leveldef.shapes then
-        local valid_keys = { 'script', 'pos', 'children', 'sensor', 'image', 'start', 'finish', 'color', 'type', 'anchor', 'tag', 'dynamic' }
-        local valid_types = { 'compound', 'line', 'edge', 'image' }
         local required_keys = { 'type' }
 
+        -- Shape lists can be nested.  Any non-empty list in a shape
+        -- list is taken to be a nested list; everything else must be
+        -- a shape.
         local function ValidateShapeList(shapes)
-            for _, shape in pairs(shapes) do
-                if #shape > 0 then
+            if type(shapes) ~= 'table' or not IsList(shapes) then
+                return Err('shapes must be a list')
+            end
+            for _, shape in ipairs(shapes) do
+                if type(shape) ~= 'table' then
+                    Err('shape must be a table')
+                elseif #shape > 0 and IsList(shape) then
                     ValidateShapeList(shape)
                 else
-                    CheckValidKeys(filename, shape, valid_keys)
+                    CheckValidKeys(filename, shape, SHAPE_KEYS)
                     CheckRequiredKeys(filename, shape, required_keys, 'shape')
-                    if not ListContains(valid_types, shape.type) then
-                        Err('invalid shape type: ' .. shape.type)
+                    if not SHAPE_TYPES[shape.type] then
+                        Err('invalid shape type: ' .. tostring(shape.type))
                     end
                 end
             end
@@ -118,6 +175,47 @@ validate.ValidateLevelDef = function(filename, gamedef, leveldef)
     end
 end
 
+-- Validation stamps that have been read, keyed by game root.
+local stamp_cache = {}
+
+--- Return true if a .def file has been checked by the native validator
+-- since it was last modified, in which case there is no need to
+-- validate it again.  This needs the levelfile module so it always
+-- returns false outside of the game.
+-- @param root the game's root directory
+-- @param name the filename relative to root
+validate.IsValidated = function(root, name)
+    if not levelfile then
+        return false
+    end
+    local stamp_filename = path.join(root, STAMP_FILE)
+    local stamp_time = levelfile.mtime(stamp_filename)
+    if not stamp_time then
+        return false
+    end
+
+    local stamps = stamp_cache[root]
+    if not stamps or stamps.time ~= stamp_time then
+        stamps = { time = stamp_time, files = {} }
+        local f = io.open(stamp_filename, 'r')
+        if f then
+            if f:read('*l') == STAMP_HEADER then
+                for line in f:lines() do
+                    local mtime, file = line:match('^(%d+) (.+)$')
+                    if mtime then
+                        stamps.files[file] = tonumber(mtime)
+                    end
+                end
+            end
+            f:close()
+        end
+        stamp_cache[root] = stamps
+    end
+
+    local mtime = stamps.files[name]
+    return mtime ~= nil and mtime == levelfile.mtime(path.join(root, name))
+end
+
 if debug.getinfo(1).what == "main" and debug.getinfo(3) == nil then
    -- When run from the command line run validation on passed in game.def file.
    local filename = arg[1]
@@ -0,0 +1,251 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Headless level simulator.  Loads a game and one of its levels and
+// steps the physics world without creating a window or GL context.
+
+#include "../src/game_manager.h"
+#include "../src/level_layer.h"
+#include "cocos2d.h"
+#include "CCLuaEngine.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+extern "C" {
+#include "lua.h"
+#include "lauxlib.h"
+}
+
+USING_NS_CC;
+
+// Simulated frame length.  This is deliberately not the same as the
+// physics timestep so that the fixed timestep code is exercised.
+#define FRAME_TIME (1.0f / 50.0f)
+
+static void Usage(const char* argv0) {
+  fprintf(stderr, "usage: %s [-r res_dir] [-g game] [-l level] "
+          "[-s seconds] [-n runs] [-c profile.csv] [-y file.yaml]\n",
+          argv0);
+  fprintf(stderr, "  -c  write the physics profile of the last run as CSV\n");
+  fprintf(stderr, "  -y  benchmark loading a yaml file (once per run) "
+          "instead of simulating a level\n");
+  exit(1);
+}
+
+static double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Print the position of every tagged body in the world.
+static void DumpBodies(b2World* world) {
+  for (b2Body* body = world->GetBodyList(); body; body = body->GetNext()) {
+    int tag = (intptr_t)body->GetUserData();
+    if (!tag)
+      continue;
+    const b2Vec2& pos = body->GetPosition();
+    printf("  body %d: %.3f, %.3f%s\n", tag, pos.x, pos.y,
+           body->IsAwake() ? "" : " (asleep)");
+  }
+}
+
+// Paths given on the command line are relative to the directory we
+// were started in.
+static std::string StartPath(const char* filename) {
+  std::string path;
+  char cwd[PATH_MAX];
+  if (filename[0] != '/' && getcwd(cwd, PATH_MAX))
+    path = std::string(cwd) + "/";
+  return path + filename;
+}
+
+// Lua allocator wrapper that tracks the size of the lua heap.
+struct AllocStats {
+  lua_Alloc alloc;
+  void* ud;
+  long current;
+  long peak;
+};
+
+static void* TrackingAlloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+  AllocStats* stats = static_cast<AllocStats*>(ud);
+  void* result = stats->alloc(stats->ud, ptr, osize, nsize);
+  if (result || !nsize) {
+    stats->current += (long)nsize - (long)osize;
+    stats->peak = std::max(stats->peak, stats->current);
+  }
+  return result;
+}
+
+// The ways of loading a yaml file compared by BenchmarkYaml.  Each is
+// a lua chunk that returns the function to call.
+static const struct {
+  const char* name;
+  const char* chunk;
+} yaml_loaders[] = {
+  { "buffered (yaml.load)",
+    "local yaml = require 'yaml'\n"
+    "return function(filename)\n"
+    "  local file = assert(io.open(filename, 'r'))\n"
+    "  local data = file:read('*all')\n"
+    "  file:close()\n"
+    "  return yaml.load(data)\n"
+    "end\n" },
+  { "streaming (yamlfile.load)", "return yamlfile.load" },
+};
+
+// Time loading a yaml file with each of yaml_loaders and measure the
+// peak size of the lua heap while doing so.  Memory used inside
+// libyaml itself isn't counted.
+static bool BenchmarkYaml(const char* filename, int runs) {
+  CCScriptEngineManager* manager = CCScriptEngineManager::sharedManager();
+  CCLuaEngine* engine = (CCLuaEngine*)manager->getScriptEngine();
+  lua_State* L = engine->getLuaStack()->getLuaState();
+
+  AllocStats stats;
+  stats.alloc = lua_getallocf(L, &stats.ud);
+  stats.current = 0;
+  stats.peak = 0;
+  lua_setallocf(L, TrackingAlloc, &stats);
+
+  bool ok = true;
+  int count = sizeof(yaml_loaders) / sizeof(yaml_loaders[0]);
+  for (int i = 0; ok && i < count; i++) {
+    if (luaL_dostring(L, yaml_loaders[i].chunk)) {
+      fprintf(stderr, "%s\n", lua_tostring(L, -1));
+      ok = false;
+      break;
+    }
+
+    double total_time = 0;
+    long peak = 0;
+    for (int run = 0; run < runs; run++) {
+      // Start each load from an empty heap (apart from the live data).
+      lua_gc(L, LUA_GCCOLLECT, 0);
+      long base = stats.current;
+      stats.peak = base;
+
+      lua_pushvalue(L, -1);
+      lua_pushstring(L, filename);
+      double start = Now();
+      int rtn = lua_pcall(L, 1, 1, 0);
+      total_time += Now() - start;
+      if (rtn) {
+        fprintf(stderr, "%s\n", lua_tostring(L, -1));
+        ok = false;
+        break;
+      }
+      lua_pop(L, 1);
+      peak = std::max(peak, stats.peak - base);
+    }
+    lua_pop(L, 1);
+
+    if (ok) {
+      printf("%s: %.2fms per load, peak lua memory %.1fKB\n",
+             yaml_loaders[i].name, total_time * 1000 / runs, peak / 1024.0);
+    }
+  }
+
+  lua_setallocf(L, stats.alloc, stats.ud);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  const char* res_dir = "../data/res";
+  const char* game = "sample_game";
+  int level_number = 1;
+  float seconds = 10;
+  int runs = 1;
+  const char* profile_file = NULL;
+  const char* yaml_file = NULL;
+
+  int c;
+  while ((c = getopt(argc, argv, "r:g:l:s:n:c:y:h")) != -1) {
+    switch (c) {
+      case 'r': res_dir = optarg; break;
+      case 'g': game = optarg; break;
+      case 'l': level_number = atoi(optarg); break;
+      case 's': seconds = atof(optarg); break;
+      case 'n': runs = atoi(optarg); break;
+      case 'c': profile_file = optarg; break;
+      case 'y': yaml_file = optarg; break;
+      default: Usage(argv[0]);
+    }
+  }
+
+  std::string profile_path;
+  if (profile_file)
+    profile_path = StartPath(profile_file);
+  std::string yaml_path;
+  if (yaml_file)
+    yaml_path = StartPath(yaml_file);
+
+  // The loader opens game files relative to the working directory.
+  if (chdir(res_dir)) {
+    perror(res_dir);
+    return 1;
+  }
+  char respath[PATH_MAX];
+  if (!getcwd(respath, PATH_MAX))
+    return 1;
+  CCFileUtils::sharedFileUtils()->addSearchPath(respath);
+
+  GameManager* manager = GameManager::sharedManager();
+  if (!manager->InitLua())
+    return 1;
+  if (yaml_file)
+    return BenchmarkYaml(yaml_path.c_str(), runs) ? 0 : 1;
+  if (!manager->LoadGame(game, true))
+    return 1;
+
+  CCScheduler* scheduler = CCDirector::sharedDirector()->getScheduler();
+  int frames = (int)(seconds / FRAME_TIME);
+  double total_time = 0;
+
+  for (int run = 0; run < runs; run++) {
+    LevelLayer* layer = LevelLayer::createHeadless();
+    layer->retain();
+    layer->LoadLevel(level_number);
+    // The layer is never added to a scene so start it by hand, which
+    // resumes the selectors that LoadLevel scheduled.
+    layer->onEnter();
+
+    double start = Now();
+    for (int i = 0; i < frames; i++)
+      scheduler->update(FRAME_TIME);
+    double elapsed = Now() - start;
+    total_time += elapsed;
+
+    printf("run %d: %d steps in %.1fms (%.3fs dropped)\n", run + 1,
+           layer->GetPhysicsSubsteps(), elapsed * 1000,
+           layer->GetDroppedPhysicsTime());
+    if (run == runs - 1) {
+      DumpBodies(layer->GetWorld());
+      if (profile_file)
+        layer->DumpPhysicsProfile(profile_path.c_str());
+    }
+
+    layer->onExit();
+    layer->cleanup();
+    layer->release();
+
+    // There is no director main loop to drain the autorelease pool.
+    CCPoolManager::sharedPoolManager()->pop();
+  }
+
+  printf("%d run(s) of %.1fs simulated in %.1fms\n", runs, seconds,
+         total_time * 1000);
+  int cache_hits, cache_misses;
+  manager->GetLevelCacheStats(&cache_hits, &cache_misses);
+  printf("level cache: %d hit(s), %d miss(es)\n", cache_hits, cache_misses);
+  return 0;
+}
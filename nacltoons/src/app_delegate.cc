@@ -3,16 +3,8 @@
 // found in the LICENSE file.
 #include "app_delegate.h"
 
-#include "CCLuaEngine.h"
-#include "LuaBox2D.h"
-#include "LuaCocos2dExtensions.h"
-#include "lua_level_layer.h"
 #include "game_manager.h"
 
-extern "C" {
-LUALIB_API int luaopen_yaml(lua_State *L);
-}
-
 USING_NS_CC;
 
 bool AppDelegate::applicationDidFinishLaunching() {
@@ -29,39 +21,10 @@ bool AppDelegate::applicationDidFinishLaunching() {
 
   director->setDisplayStats(true);
 
-  // Create lua engine
-  CCLuaEngine* engine = CCLuaEngine::defaultEngine();
-  assert(engine);
-  if (!engine)
-    return false;
-
-  CCScriptEngineManager::sharedManager()->setScriptEngine(engine);
-
-  // Add custom lua bindings on top of what cocos2dx provides
-  CCLuaStack* stack = engine->getLuaStack();
-  lua_State* lua_state = stack->getLuaState();
-  assert(lua_state);
-  // add box2D bindings
-  tolua_LuaBox2D_open(lua_state);
-  // add LevelLayer bindings
-  tolua_level_layer_open(lua_state);
-  // add cocos2dx extensions bindings
-  tolua_extensions_open(lua_state);
-  // add yaml bindings
-  luaopen_yaml(lua_state);
-
-  CCFileUtils* utils = CCFileUtils::sharedFileUtils();
-  std::string path = utils->fullPathForFilename("loader.lua");
-
-  // add the location of the lua file to the search path
-  engine->addSearchPath(path.substr(0, path.find_last_of("/")).c_str());
-
-  // execute loader file
-  int rtn = engine->executeScriptFile(path.c_str());
-  assert(!rtn);
-  if (rtn)
+  GameManager* manager = GameManager::sharedManager();
+  if (!manager->InitLua())
     return false;
 
-  GameManager::sharedManager()->LoadGame("sample_game");
+  manager->LoadGame("sample_game");
   return true;
 }
@@ -0,0 +1,163 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "debug_draw.h"
+
+#include <stddef.h>
+
+// Number of segments used to draw circles.
+#define CIRCLE_SEGMENTS 16
+
+// Length (in meters) of the axes drawn by DrawTransform.
+#define AXIS_SCALE 0.4f
+
+// Size (in pixels) of contact points and length (in meters) of
+// contact normals.
+#define CONTACT_POINT_SIZE 4.0f
+#define CONTACT_NORMAL_SCALE 0.3f
+
+static ccColor4B ToColor(const b2Color& color, float alpha) {
+  return ccc4(color.r * 255, color.g * 255, color.b * 255, alpha * 255);
+}
+
+// Solid shapes are filled with a translucent, darker version of their
+// outline color as GLESDebugDraw does.
+static ccColor4B ToFillColor(const b2Color& color) {
+  return ccc4(color.r * 127, color.g * 127, color.b * 127, 127);
+}
+
+DebugDraw::DebugDraw(float ratio) : ratio_(ratio) {
+  CCShaderCache* shaders = CCShaderCache::sharedShaderCache();
+  shader_ = shaders->programForKey(kCCShader_PositionColor);
+}
+
+void DebugDraw::Clear() {
+  triangles_.clear();
+  lines_.clear();
+}
+
+void DebugDraw::AddVertex(std::vector<Vertex>* list, const b2Vec2& point,
+                          const ccColor4B& color) {
+  Vertex vertex;
+  vertex.position = vertex2(point.x * ratio_, point.y * ratio_);
+  vertex.color = color;
+  list->push_back(vertex);
+}
+
+void DebugDraw::AddLine(const b2Vec2& p1, const b2Vec2& p2,
+                        const ccColor4B& color) {
+  AddVertex(&lines_, p1, color);
+  AddVertex(&lines_, p2, color);
+}
+
+void DebugDraw::AddPoint(const b2Vec2& point, float size,
+                         const ccColor4B& color) {
+  float half = size / 2 / ratio_;
+  b2Vec2 bl(point.x - half, point.y - half);
+  b2Vec2 br(point.x + half, point.y - half);
+  b2Vec2 tl(point.x - half, point.y + half);
+  b2Vec2 tr(point.x + half, point.y + half);
+  AddVertex(&triangles_, bl, color);
+  AddVertex(&triangles_, br, color);
+  AddVertex(&triangles_, tl, color);
+  AddVertex(&triangles_, br, color);
+  AddVertex(&triangles_, tr, color);
+  AddVertex(&triangles_, tl, color);
+}
+
+void DebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertex_count,
+                            const b2Color& color) {
+  ccColor4B line_color = ToColor(color, 1);
+  for (int32 i = 0; i < vertex_count; i++)
+    AddLine(vertices[i], vertices[(i + 1) % vertex_count], line_color);
+}
+
+void DebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertex_count,
+                                 const b2Color& color) {
+  // box2d polygons are convex so they can be filled as a fan.
+  ccColor4B fill_color = ToFillColor(color);
+  for (int32 i = 1; i < vertex_count - 1; i++) {
+    AddVertex(&triangles_, vertices[0], fill_color);
+    AddVertex(&triangles_, vertices[i], fill_color);
+    AddVertex(&triangles_, vertices[i + 1], fill_color);
+  }
+  DrawPolygon(vertices, vertex_count, color);
+}
+
+void DebugDraw::DrawCircle(const b2Vec2& center, float32 radius,
+                           const b2Color& color) {
+  b2Vec2 points[CIRCLE_SEGMENTS];
+  for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+    float32 angle = 2 * b2_pi * i / CIRCLE_SEGMENTS;
+    points[i] = center + radius * b2Vec2(cosf(angle), sinf(angle));
+  }
+  DrawPolygon(points, CIRCLE_SEGMENTS, color);
+}
+
+void DebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius,
+                                const b2Vec2& axis, const b2Color& color) {
+  b2Vec2 points[CIRCLE_SEGMENTS];
+  for (int i = 0; i < CIRCLE_SEGMENTS; i++) {
+    float32 angle = 2 * b2_pi * i / CIRCLE_SEGMENTS;
+    points[i] = center + radius * b2Vec2(cosf(angle), sinf(angle));
+  }
+  DrawSolidPolygon(points, CIRCLE_SEGMENTS, color);
+  AddLine(center, center + radius * axis, ToColor(color, 1));
+}
+
+void DebugDraw::DrawSegment(const b2Vec2& p1, const b2Vec2& p2,
+                            const b2Color& color) {
+  AddLine(p1, p2, ToColor(color, 1));
+}
+
+void DebugDraw::DrawTransform(const b2Transform& xf) {
+  AddLine(xf.p, xf.p + AXIS_SCALE * xf.q.GetXAxis(), ccc4(255, 0, 0, 255));
+  AddLine(xf.p, xf.p + AXIS_SCALE * xf.q.GetYAxis(), ccc4(0, 255, 0, 255));
+}
+
+void DebugDraw::DrawContacts(b2World* world) {
+  if (!(GetFlags() & e_contactBit))
+    return;
+
+  ccColor4B point_color = ccc4(255, 255, 0, 255);
+  ccColor4B normal_color = ccc4(0, 255, 255, 255);
+  for (b2Contact* contact = world->GetContactList(); contact;
+       contact = contact->GetNext()) {
+    if (!contact->IsTouching())
+      continue;
+    b2WorldManifold manifold;
+    contact->GetWorldManifold(&manifold);
+    int32 count = contact->GetManifold()->pointCount;
+    for (int32 i = 0; i < count; i++) {
+      const b2Vec2& point = manifold.points[i];
+      AddPoint(point, CONTACT_POINT_SIZE, point_color);
+      AddLine(point, point + CONTACT_NORMAL_SCALE * manifold.normal,
+              normal_color);
+    }
+  }
+}
+
+void DebugDraw::DrawVertices(const std::vector<Vertex>& vertices,
+                             GLenum mode) {
+  if (vertices.empty())
+    return;
+  const char* base = reinterpret_cast<const char*>(&vertices[0]);
+  GLsizei stride = sizeof(Vertex);
+  glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE,
+                        stride, base + offsetof(Vertex, position));
+  glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                        stride, base + offsetof(Vertex, color));
+  glDrawArrays(mode, 0, vertices.size());
+  CC_INCREMENT_GL_DRAWS(1);
+}
+
+void DebugDraw::Flush() {
+  shader_->use();
+  shader_->setUniformsForBuiltins();
+  ccGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position |
+                          kCCVertexAttribFlag_Color);
+  // Fills first so that outlines are drawn over them.
+  DrawVertices(triangles_, GL_TRIANGLES);
+  DrawVertices(lines_, GL_LINES);
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef DEBUG_DRAW_H_
+#define DEBUG_DRAW_H_
+
+#include <vector>
+
+#include "cocos2d.h"
+#include "Box2D/Box2D.h"
+
+USING_NS_CC;
+
+/**
+ * Box2D debug renderer that collects everything drawn during a frame
+ * into vertex arrays and draws them with one call for filled shapes
+ * and one for lines, rather than a draw call per shape.  Usage is:
+ * Clear(), b2World::DrawDebugData() and DrawContacts(), then Flush().
+ */
+class DebugDraw : public b2Draw {
+ public:
+  // Extra flag (alongside the b2Draw ones) for drawing contact points
+  // and normals.
+  enum {
+    e_contactBit = 0x0100
+  };
+
+  explicit DebugDraw(float ratio);
+
+  // Discard everything collected since the last flush.
+  void Clear();
+
+  // Collect the contact points of all touching contacts in 'world'
+  // if e_contactBit is set.
+  void DrawContacts(b2World* world);
+
+  // Draw everything collected so far.  Uses the current modelview
+  // matrix.
+  void Flush();
+
+  virtual void DrawPolygon(const b2Vec2* vertices, int32 vertex_count,
+                           const b2Color& color);
+  virtual void DrawSolidPolygon(const b2Vec2* vertices, int32 vertex_count,
+                                const b2Color& color);
+  virtual void DrawCircle(const b2Vec2& center, float32 radius,
+                          const b2Color& color);
+  virtual void DrawSolidCircle(const b2Vec2& center, float32 radius,
+                               const b2Vec2& axis, const b2Color& color);
+  virtual void DrawSegment(const b2Vec2& p1, const b2Vec2& p2,
+                           const b2Color& color);
+  virtual void DrawTransform(const b2Transform& xf);
+
+ private:
+  struct Vertex {
+    ccVertex2F position;
+    ccColor4B color;
+  };
+
+  void AddVertex(std::vector<Vertex>* list, const b2Vec2& point,
+                 const ccColor4B& color);
+  void AddLine(const b2Vec2& p1, const b2Vec2& p2, const ccColor4B& color);
+  void AddPoint(const b2Vec2& point, float size, const ccColor4B& color);
+  void DrawVertices(const std::vector<Vertex>& vertices, GLenum mode);
+
+  // Pixels per box2d meter.
+  float ratio_;
+  CCGLProgram* shader_;
+  std::vector<Vertex> triangles_;
+  std::vector<Vertex> lines_;
+};
+
+#endif  // DEBUG_DRAW_H_
@@ -2,8 +2,18 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 #include "game_manager.h"
+#include "level_builder.h"
+#include "level_file.h"
 #include "level_layer.h"
 #include "CCLuaEngine.h"
+#include "LuaBox2D.h"
+#include "LuaCocos2dExtensions.h"
+#include "lua_level_layer.h"
+#include "yaml_file.h"
+
+extern "C" {
+LUALIB_API int luaopen_yaml(lua_State *L);
+}
 
 USING_NS_CC;
 
@@ -29,7 +39,50 @@ void GameManager::Restart()
   CreateLevel();
 }
 
-bool GameManager::LoadGame(const char* folder) {
+bool GameManager::InitLua() {
+  // Create lua engine
+  CCLuaEngine* engine = CCLuaEngine::defaultEngine();
+  assert(engine);
+  if (!engine)
+    return false;
+
+  CCScriptEngineManager::sharedManager()->setScriptEngine(engine);
+
+  // Add custom lua bindings on top of what cocos2dx provides
+  CCLuaStack* stack = engine->getLuaStack();
+  lua_State* lua_state = stack->getLuaState();
+  assert(lua_state);
+  // add box2D bindings
+  tolua_LuaBox2D_open(lua_state);
+  // add LevelLayer bindings
+  tolua_level_layer_open(lua_state);
+  // add cocos2dx extensions bindings
+  tolua_extensions_open(lua_state);
+  // add yaml bindings
+  luaopen_yaml(lua_state);
+  // add streaming yaml file loader
+  luaopen_yamlfile(lua_state);
+  // add loader for compiled level files
+  luaopen_levelfile(lua_state);
+  // add native level builder
+  luaopen_levelbuilder(lua_state);
+
+  CCFileUtils* utils = CCFileUtils::sharedFileUtils();
+  std::string path = utils->fullPathForFilename("loader.lua");
+
+  // add the location of the lua file to the search path
+  engine->addSearchPath(path.substr(0, path.find_last_of("/")).c_str());
+
+  // execute loader file
+  int rtn = engine->executeScriptFile(path.c_str());
+  assert(!rtn);
+  if (rtn)
+    return false;
+
+  return true;
+}
+
+bool GameManager::LoadGame(const char* folder, bool headless) {
   CCScriptEngineManager* manager = CCScriptEngineManager::sharedManager();
   CCLuaEngine* engine = (CCLuaEngine*)manager->getScriptEngine();
   assert(engine);
@@ -38,10 +91,11 @@ bool GameManager::LoadGame(const char* folder) {
 
   CCLog("running LoadGame on stack: %p", lua_stack);
   lua_stack->pushString(folder);
+  lua_stack->pushBoolean(headless);
 
-  // Call 'LoadGame' with single argument pushed above.
+  // Call 'LoadGame' with the two arguments pushed above.
   // 'LoadGame' is a global symbol defined in loader.lua.
-  int rtn = lua_stack->executeFunctionByName("LoadGame", 1);
+  int rtn = lua_stack->executeFunctionByName("LoadGame", 2);
   assert(rtn != -1);
   if (rtn != 1)
     return false;
@@ -49,6 +103,26 @@ bool GameManager::LoadGame(const char* folder) {
   return true;
 }
 
+void GameManager::GetLevelCacheStats(int* hits, int* misses) {
+  CCScriptEngineManager* manager = CCScriptEngineManager::sharedManager();
+  CCLuaEngine* engine = (CCLuaEngine*)manager->getScriptEngine();
+  assert(engine);
+  lua_State* state = engine->getLuaStack()->getLuaState();
+
+  *hits = 0;
+  *misses = 0;
+  // 'GetLevelCacheStats' is a global symbol defined in loader.lua.
+  lua_getglobal(state, "GetLevelCacheStats");
+  if (lua_pcall(state, 0, 2, 0) != 0) {
+    CCLog("GetLevelCacheStats failed: %s", lua_tostring(state, -1));
+    lua_pop(state, 1);
+    return;
+  }
+  *hits = lua_tointeger(state, -2);
+  *misses = lua_tointeger(state, -1);
+  lua_pop(state, 2);
+}
+
 void GameManager::LoadLevel(int level_number)
 {
   CCDirector* director = CCDirector::sharedDirector();
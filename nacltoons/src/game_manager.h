@@ -28,7 +28,18 @@ class GameManager {
   void GameOver(bool success);
   void LoadLevel(int level_number);
   static GameManager* sharedManager();
-  bool LoadGame(const char* folder);
+
+  // Create the lua engine, register our bindings and run loader.lua.
+  bool InitLua();
+
+  // Load the game in the given folder.  In headless mode only the
+  // level data and physics are loaded; the game's script and any
+  // menus or audio are skipped.
+  bool LoadGame(const char* folder, bool headless = false);
+
+  // Get the number of level loads served from the lua level cache
+  // and the number that had to read the level from disk.
+  void GetLevelCacheStats(int* hits, int* misses);
  private:
   void CreateLevel();
   GameManager() : level_number_(0), scene_(NULL) {}
@@ -0,0 +1,290 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "geometry.h"
+
+USING_NS_CC;
+
+// Distance from 'point' to the line segment from 'start' to 'end'.
+static float DistanceToSegment(const CCPoint& point, const CCPoint& start,
+                               const CCPoint& end) {
+  CCPoint segment = ccpSub(end, start);
+  float length_sq = ccpLengthSQ(segment);
+  if (length_sq == 0)
+    return ccpDistance(point, start);
+  float t = ccpDot(ccpSub(point, start), segment) / length_sq;
+  t = clampf(t, 0.0f, 1.0f);
+  return ccpDistance(point, ccpAdd(start, ccpMult(segment, t)));
+}
+
+void SimplifyPolyline(const PointList& points, float tolerance,
+                      PointList* result) {
+  result->clear();
+  if (points.size() < 3) {
+    *result = points;
+    return;
+  }
+
+  // Iterative version of the algorithm using an explicit stack of
+  // [first, last] ranges, so long strokes can't overflow the C stack.
+  std::vector<bool> keep(points.size(), false);
+  keep.front() = true;
+  keep.back() = true;
+  std::vector<std::pair<size_t, size_t> > ranges;
+  ranges.push_back(std::make_pair(0, points.size() - 1));
+  while (!ranges.empty()) {
+    size_t first = ranges.back().first;
+    size_t last = ranges.back().second;
+    ranges.pop_back();
+
+    float max_distance = 0;
+    size_t farthest = first;
+    for (size_t i = first + 1; i < last; i++) {
+      float distance = DistanceToSegment(points[i], points[first],
+                                         points[last]);
+      if (distance > max_distance) {
+        max_distance = distance;
+        farthest = i;
+      }
+    }
+
+    if (max_distance > tolerance) {
+      keep[farthest] = true;
+      ranges.push_back(std::make_pair(first, farthest));
+      ranges.push_back(std::make_pair(farthest, last));
+    }
+  }
+
+  for (size_t i = 0; i < points.size(); i++) {
+    if (keep[i])
+      result->push_back(points[i]);
+  }
+}
+
+// Twice the signed area of the triangle a, b, c.  Positive when the
+// points turn counter-clockwise.
+static float Cross(const CCPoint& a, const CCPoint& b, const CCPoint& c) {
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+float PolygonArea(const PointList& polygon) {
+  float area = 0;
+  for (size_t i = 0; i < polygon.size(); i++) {
+    const CCPoint& p = polygon[i];
+    const CCPoint& q = polygon[(i + 1) % polygon.size()];
+    area += p.x * q.y - q.x * p.y;
+  }
+  return area / 2;
+}
+
+static bool SegmentsIntersect(const CCPoint& a, const CCPoint& b,
+                              const CCPoint& c, const CCPoint& d) {
+  float d1 = Cross(c, d, a);
+  float d2 = Cross(c, d, b);
+  float d3 = Cross(a, b, c);
+  float d4 = Cross(a, b, d);
+  return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+         ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+bool IsSimplePolygon(const PointList& polygon) {
+  size_t n = polygon.size();
+  if (n < 3)
+    return false;
+  for (size_t i = 0; i < n; i++) {
+    // Adjacent edges share a vertex so only test non-adjacent ones.
+    for (size_t j = i + 2; j < n; j++) {
+      if (i == 0 && j == n - 1)
+        continue;
+      if (SegmentsIntersect(polygon[i], polygon[i + 1], polygon[j],
+                            polygon[(j + 1) % n]))
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool PointInTriangle(const CCPoint& p, const CCPoint& a,
+                            const CCPoint& b, const CCPoint& c) {
+  return Cross(a, b, p) >= 0 && Cross(b, c, p) >= 0 && Cross(c, a, p) >= 0;
+}
+
+bool TriangulatePolygon(const PointList& polygon,
+                        std::vector<int>* triangles) {
+  triangles->clear();
+  int n = polygon.size();
+  if (n < 3)
+    return false;
+
+  // Work on a counter-clockwise list of remaining vertex indices.
+  bool ccw = PolygonArea(polygon) > 0;
+  std::vector<int> remaining(n);
+  for (int i = 0; i < n; i++)
+    remaining[i] = ccw ? i : n - 1 - i;
+
+  while (remaining.size() > 3) {
+    int count = remaining.size();
+    bool found_ear = false;
+    for (int i = 0; i < count; i++) {
+      int prev = remaining[(i + count - 1) % count];
+      int cur = remaining[i];
+      int next = remaining[(i + 1) % count];
+      const CCPoint& a = polygon[prev];
+      const CCPoint& b = polygon[cur];
+      const CCPoint& c = polygon[next];
+      // Reflex (or degenerate) vertices can't be ears.
+      if (Cross(a, b, c) <= 0)
+        continue;
+
+      bool contains_vertex = false;
+      for (int j = 0; j < count; j++) {
+        int other = remaining[j];
+        if (other == prev || other == cur || other == next)
+          continue;
+        if (PointInTriangle(polygon[other], a, b, c)) {
+          contains_vertex = true;
+          break;
+        }
+      }
+      if (contains_vertex)
+        continue;
+
+      triangles->push_back(prev);
+      triangles->push_back(cur);
+      triangles->push_back(next);
+      remaining.erase(remaining.begin() + i);
+      found_ear = true;
+      break;
+    }
+
+    if (!found_ear)
+      return false;
+  }
+
+  triangles->push_back(remaining[0]);
+  triangles->push_back(remaining[1]);
+  triangles->push_back(remaining[2]);
+  return true;
+}
+
+// Returns true if the polygon with the given vertex indices is convex.
+static bool IsConvex(const PointList& points, const std::vector<int>& poly) {
+  size_t n = poly.size();
+  for (size_t i = 0; i < n; i++) {
+    if (Cross(points[poly[i]], points[poly[(i + 1) % n]],
+              points[poly[(i + 2) % n]]) < 0)
+      return false;
+  }
+  return true;
+}
+
+// Remove vertices of the polygon with the given vertex indices that
+// are within 'tolerance' of the segment joining their neighbours.  This
+// drops both near-duplicate and collinear points.
+static void RemoveDegenerateVertices(const PointList& points, float tolerance,
+                                     std::vector<int>* poly) {
+  bool changed = true;
+  while (changed && poly->size() >= 3) {
+    changed = false;
+    for (size_t i = 0; i < poly->size() && poly->size() >= 3; i++) {
+      size_t n = poly->size();
+      const CCPoint& prev = points[(*poly)[(i + n - 1) % n]];
+      const CCPoint& next = points[(*poly)[(i + 1) % n]];
+      if (DistanceToSegment(points[(*poly)[i]], prev, next) > tolerance)
+        continue;
+      poly->erase(poly->begin() + i);
+      i--;
+      changed = true;
+    }
+  }
+}
+
+// If 'a' and 'b' share an edge, store the polygon formed by joining
+// them across it in 'merged' and return true.
+static bool MergeAcrossEdge(const std::vector<int>& a,
+                            const std::vector<int>& b,
+                            std::vector<int>* merged) {
+  size_t na = a.size();
+  size_t nb = b.size();
+  for (size_t i = 0; i < na; i++) {
+    int from = a[i];
+    int to = a[(i + 1) % na];
+    // Both pieces are counter-clockwise so a shared edge runs in the
+    // opposite direction in 'b'.
+    for (size_t j = 0; j < nb; j++) {
+      if (b[j] != to || b[(j + 1) % nb] != from)
+        continue;
+      merged->clear();
+      // Walk 'a' from 'to' round to 'from', then 'b' from the vertex
+      // after 'from' round to the vertex before 'to'.
+      for (size_t k = 0; k < na; k++)
+        merged->push_back(a[(i + 1 + k) % na]);
+      for (size_t k = 2; k < nb; k++)
+        merged->push_back(b[(j + k) % nb]);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool DecomposePolygon(const PointList& polygon, int max_vertices,
+                      float tolerance, std::vector<PointList>* pieces) {
+  pieces->clear();
+  if (max_vertices < 3)
+    return false;
+
+  std::vector<int> outline(polygon.size());
+  for (size_t i = 0; i < polygon.size(); i++)
+    outline[i] = i;
+  RemoveDegenerateVertices(polygon, tolerance, &outline);
+  PointList points;
+  for (size_t i = 0; i < outline.size(); i++)
+    points.push_back(polygon[outline[i]]);
+
+  if (!IsSimplePolygon(points))
+    return false;
+
+  std::vector<int> triangles;
+  if (!TriangulatePolygon(points, &triangles))
+    return false;
+
+  std::vector<std::vector<int> > polys;
+  for (size_t i = 0; i < triangles.size(); i += 3)
+    polys.push_back(std::vector<int>(&triangles[i], &triangles[i] + 3));
+
+  // Greedily merge neighbours until no more merges are possible.  Joining
+  // two pieces can leave a collinear vertex where the shared edge ended,
+  // so those are removed before checking the vertex count.
+  std::vector<int> merged;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 0; i < polys.size() && !changed; i++) {
+      for (size_t j = i + 1; j < polys.size(); j++) {
+        if (!MergeAcrossEdge(polys[i], polys[j], &merged))
+          continue;
+        RemoveDegenerateVertices(points, tolerance, &merged);
+        if (merged.size() < 3 || merged.size() > (size_t)max_vertices)
+          continue;
+        if (!IsConvex(points, merged))
+          continue;
+        polys[i] = merged;
+        polys.erase(polys.begin() + j);
+        changed = true;
+        break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < polys.size(); i++) {
+    // Slivers collapse to fewer than three vertices and are dropped.
+    RemoveDegenerateVertices(points, tolerance, &polys[i]);
+    if (polys[i].size() < 3)
+      continue;
+    PointList piece;
+    for (size_t j = 0; j < polys[i].size(); j++)
+      piece.push_back(points[polys[i][j]]);
+    pieces->push_back(piece);
+  }
+  return true;
+}
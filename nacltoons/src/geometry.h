@@ -0,0 +1,43 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef GEOMETRY_H_
+#define GEOMETRY_H_
+
+#include <vector>
+
+#include "cocos2d.h"
+
+typedef std::vector<cocos2d::CCPoint> PointList;
+
+// Simplify a polyline using the Ramer-Douglas-Peucker algorithm.  Points
+// closer than 'tolerance' to the simplified line are dropped.  The first
+// and last points are always kept.
+void SimplifyPolyline(const PointList& points, float tolerance,
+                      PointList* result);
+
+// Signed area of a polygon.  Positive when the points are in
+// counter-clockwise order.
+float PolygonArea(const PointList& polygon);
+
+// Returns true if no two edges of the polygon cross.
+bool IsSimplePolygon(const PointList& polygon);
+
+// Split a simple polygon (in either winding order) into triangles by
+// ear clipping.  Each triangle is three indices into 'polygon' in
+// counter-clockwise order.  Returns false if the polygon could not be
+// triangulated.
+bool TriangulatePolygon(const PointList& polygon, std::vector<int>* triangles);
+
+// Split a simple polygon into convex counter-clockwise pieces with at
+// most 'max_vertices' vertices each.  The polygon is triangulated and
+// then neighbouring pieces are merged while they stay convex
+// (Hertel-Mehlhorn), which gives at most four times the minimum number
+// of pieces.  Vertices within 'tolerance' of the line through their
+// neighbours are removed from the outline and from every piece, so no
+// piece has collinear or near-duplicate points.  Returns false if the
+// polygon is not simple.
+bool DecomposePolygon(const PointList& polygon, int max_vertices,
+                      float tolerance, std::vector<PointList>* pieces);
+
+#endif  // GEOMETRY_H_
@@ -0,0 +1,481 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "level_builder.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "level_layer.h"
+#include "physics_node.h"
+#include "stroke_batch.h"
+#include "stroke_node.h"
+
+extern "C" {
+#include "lua.h"
+#include "tolua++.h"
+#include "lauxlib.h"
+#include "tolua_fix.h"
+}
+
+LevelBuilder::LevelBuilder(lua_State* L, LevelLayer* layer) :
+    L_(L),
+    layer_(layer),
+    brush_(NULL),
+    static_brush_(NULL),
+    thickness_(0),
+    headless_(false),
+    assets_index_(0),
+    image_size_index_(0),
+    ptm_ratio_(1),
+    stroke_tag_(0),
+    origin_(CCDirector::sharedDirector()->getVisibleOrigin()) {
+}
+
+void LevelBuilder::SetMaterial(float density, float friction,
+                               float restitution) {
+  material_.density = density;
+  material_.friction = friction;
+  material_.restitution = restitution;
+}
+
+void LevelBuilder::SetBrush(StrokeBatch* brush, StrokeBatch* static_brush,
+                            float thickness) {
+  brush_ = brush;
+  static_brush_ = static_brush;
+  thickness_ = thickness;
+}
+
+void LevelBuilder::Build(int shapes_index, int first_tag) {
+  lua_newtable(L_);
+  int tag_map_index = lua_gettop(L_);
+  lua_newtable(L_);
+  int objects_index = lua_gettop(L_);
+
+  // All the shapes are tagged before any are built so that problems
+  // such as duplicate tags are found before anything is created.
+  int next_tag = first_tag;
+  CollectShapes(shapes_index, tag_map_index, objects_index, &next_tag);
+
+  int count = lua_objlen(L_, objects_index);
+  for (int i = 1; i <= count; i++) {
+    lua_rawgeti(L_, objects_index, i);
+    int index = lua_gettop(L_);
+    bool cacheable = cacheable_[i - 1];
+    PhysicsNode* node = BuildShape(index, cacheable);
+    if (node) {
+      toluafix_pushusertype_ccobject(L_, node->m_uID, &node->m_nLuaID,
+                                     node, "PhysicsNode");
+      lua_setfield(L_, index, "node");
+      if (cacheable && !headless_)
+        layer_->AddStaticNode(node);
+    }
+    lua_pop(L_, 1);
+  }
+  CCLog("built %d shapes", count);
+}
+
+void LevelBuilder::CollectShapes(int list_index, int tag_map_index,
+                                 int objects_index, int* next_tag) {
+  luaL_checkstack(L_, 4, "shape lists nested too deeply");
+  int count = lua_objlen(L_, list_index);
+  for (int i = 1; i <= count; i++) {
+    lua_rawgeti(L_, list_index, i);
+    int index = lua_gettop(L_);
+    if (!lua_istable(L_, index))
+      luaL_error(L_, "shape %d is not a table", i);
+
+    // Shape defs can be grouped into nested lists.
+    if (lua_objlen(L_, index) > 0) {
+      CollectShapes(index, tag_map_index, objects_index, next_tag);
+      lua_pop(L_, 1);
+      continue;
+    }
+
+    int tag = (*next_tag)++;
+    cacheable_.push_back(IsCacheable(index));
+    // Shapes without a tag are known by their number.
+    lua_getfield(L_, index, "tag");
+    if (lua_isnil(L_, -1)) {
+      lua_pop(L_, 1);
+      lua_pushinteger(L_, tag);
+      lua_tostring(L_, -1);
+    }
+    if (!lua_isstring(L_, -1))
+      luaL_error(L_, "invalid object tag in shape %d", i);
+
+    lua_pushvalue(L_, -1);
+    lua_rawget(L_, tag_map_index);
+    if (!lua_isnil(L_, -1))
+      luaL_error(L_, "duplicate object tag: %s", lua_tostring(L_, -2));
+    lua_pop(L_, 1);
+
+    lua_pushvalue(L_, -1);
+    lua_pushinteger(L_, tag);
+    lua_rawset(L_, tag_map_index);
+    lua_setfield(L_, index, "tag_str");
+    lua_pushinteger(L_, tag);
+    lua_setfield(L_, index, "tag");
+
+    lua_pushvalue(L_, index);
+    lua_rawseti(L_, objects_index, lua_objlen(L_, objects_index) + 1);
+    lua_pop(L_, 1);
+  }
+}
+
+bool LevelBuilder::IsCacheable(int index) {
+  if (GetBool(index, "dynamic") || GetBool(index, "sensor"))
+    return false;
+  // Scripts find the shapes they change by their tags.
+  lua_getfield(L_, index, "tag");
+  lua_getfield(L_, index, "script");
+  bool scripted = !lua_isnil(L_, -2) || !lua_isnil(L_, -1);
+  lua_pop(L_, 2);
+  if (scripted)
+    return false;
+
+  // Sensors can also be among the children of compound shapes.
+  lua_getfield(L_, index, "children");
+  int children_index = lua_gettop(L_);
+  bool cacheable = true;
+  if (lua_istable(L_, children_index)) {
+    int count = lua_objlen(L_, children_index);
+    for (int i = 1; cacheable && i <= count; i++) {
+      lua_rawgeti(L_, children_index, i);
+      if (lua_istable(L_, -1) && GetBool(lua_gettop(L_), "sensor"))
+        cacheable = false;
+      lua_pop(L_, 1);
+    }
+  }
+  lua_pop(L_, 1);
+  return cacheable;
+}
+
+PhysicsNode* LevelBuilder::BuildShape(int index, bool cacheable) {
+  lua_getfield(L_, index, "type");
+  const char* type = lua_tostring(L_, -1);
+  lua_pop(L_, 1);
+  if (!type)
+    luaL_error(L_, "shape is missing 'type'");
+  lua_getfield(L_, index, "tag");
+  int tag = lua_tointeger(L_, -1);
+  lua_pop(L_, 1);
+  bool dynamic = GetBool(index, "dynamic");
+
+  PhysicsNode* node = NULL;
+  if (!strcmp(type, "compound")) {
+    node = CreatePhysicsNode(GetPoint(index, "pos", true), dynamic, tag);
+    StrokeNode* stroke = CreateStrokeNode(node, cacheable);
+    lua_getfield(L_, index, "children");
+    int children_index = lua_gettop(L_);
+    if (lua_istable(L_, children_index)) {
+      // Compute the mass once all the children have been added.
+      node->BeginFixtures();
+      int count = lua_objlen(L_, children_index);
+      for (int i = 1; i <= count; i++) {
+        lua_rawgeti(L_, children_index, i);
+        int child_index = lua_gettop(L_);
+        lua_pushinteger(L_, tag);
+        lua_setfield(L_, child_index, "tag");
+        AddChildShape(node, stroke, child_index, false);
+        lua_pop(L_, 1);
+      }
+      node->EndFixtures();
+    }
+    lua_pop(L_, 1);
+  } else if (!strcmp(type, "line")) {
+    node = CreatePhysicsNode(GetPoint(index, "start", true), dynamic, tag);
+    StrokeNode* stroke = CreateStrokeNode(node, cacheable);
+    AddChildShape(node, stroke, index, true);
+  } else if (!strcmp(type, "edge")) {
+    CCPoint start = GetPoint(index, "start", true);
+    CCPoint finish = GetPoint(index, "finish", true);
+    b2BodyDef body_def;
+    b2Body* body = layer_->GetWorld()->CreateBody(&body_def);
+    b2EdgeShape shape;
+    shape.Set(b2Vec2(start.x / ptm_ratio_, start.y / ptm_ratio_),
+              b2Vec2(finish.x / ptm_ratio_, finish.y / ptm_ratio_));
+    body->CreateFixture(&shape, 0);
+    return NULL;
+  } else if (!strcmp(type, "image")) {
+    node = CreatePhysicsNode(GetPoint(index, "pos", true), dynamic, tag);
+    AddChildShape(node, NULL, index, true);
+  } else {
+    luaL_error(L_, "invalid shape type: %s", type);
+  }
+
+  lua_getfield(L_, index, "anchor");
+  bool anchored = !lua_isnil(L_, -1);
+  lua_pop(L_, 1);
+  if (anchored)
+    CreatePivot(GetPoint(index, "anchor", true), node->getB2Body());
+  return node;
+}
+
+void LevelBuilder::AddChildShape(PhysicsNode* node, StrokeNode* stroke,
+                                 int index, bool absolute) {
+  lua_getfield(L_, index, "type");
+  const char* type = lua_tostring(L_, -1);
+  lua_pop(L_, 1);
+  if (type && !strcmp(type, "line")) {
+    AddLine(node, stroke, GetPoint(index, "start", absolute),
+            GetPoint(index, "finish", absolute), GetColor(index), absolute);
+  } else if (type && !strcmp(type, "image")) {
+    AddSprite(node, index, absolute);
+  } else {
+    luaL_error(L_, "invalid shape type: %s", type ? type : "nil");
+  }
+}
+
+PhysicsNode* LevelBuilder::CreatePhysicsNode(const CCPoint& location,
+                                             bool dynamic, int tag) {
+  b2BodyDef body_def;
+  if (dynamic)
+    body_def.type = b2_dynamicBody;
+  b2Body* body = layer_->GetWorld()->CreateBody(&body_def);
+  PhysicsNode* node = PhysicsNode::create();
+  node->setB2Body(body);
+  node->setPTMRatio(ptm_ratio_);
+  node->setPosition(location);
+  node->setTag(tag);
+  body->SetUserData(reinterpret_cast<void*>(static_cast<intptr_t>(tag)));
+  layer_->addChild(node, 1, tag);
+  return node;
+}
+
+StrokeNode* LevelBuilder::CreateStrokeNode(PhysicsNode* parent,
+                                           bool is_static) {
+  if (headless_ || !brush_)
+    return NULL;
+  StrokeNode* stroke = StrokeNode::create(brush_->getTexture(), thickness_);
+  parent->addChild(stroke, 1, stroke_tag_);
+  if (is_static && static_brush_)
+    static_brush_->AddStroke(stroke);
+  else
+    brush_->AddStroke(stroke);
+  return stroke;
+}
+
+b2Fixture* LevelBuilder::AddFixture(PhysicsNode* node, b2Shape* shape,
+                                    bool sensor) {
+  b2FixtureDef fixture_def = material_;
+  fixture_def.shape = shape;
+  fixture_def.isSensor = sensor;
+  return node->AddFixture(&fixture_def);
+}
+
+void LevelBuilder::AddLine(PhysicsNode* node, StrokeNode* stroke,
+                           const CCPoint& from, const CCPoint& to,
+                           const ccColor3B& color, bool absolute) {
+  float length = ccpDistance(from, to);
+  CCPoint delta = ccpSub(to, from);
+  CCPoint rel_start = absolute ? node->convertToNodeSpace(from) : from;
+  CCPoint rel_end = ccpAdd(rel_start, delta);
+
+  // A box as thick as the brush along the line.
+  b2Vec2 center((rel_start.x + delta.x / 2) / ptm_ratio_,
+                (rel_start.y + delta.y / 2) / ptm_ratio_);
+  b2PolygonShape shape;
+  shape.SetAsBox(length / 2 / ptm_ratio_, thickness_ / ptm_ratio_, center,
+                 atan2f(delta.y, delta.x));
+  AddFixture(node, &shape, false);
+
+  if (stroke)
+    stroke->AddLine(rel_start, rel_end, color);
+}
+
+void LevelBuilder::AddSprite(PhysicsNode* node, int index, bool absolute) {
+  CCPoint pos = GetPoint(index, "pos", absolute);
+  const char* image = GetImage(index);
+  CCPoint rel_pos = absolute ? node->convertToNodeSpace(pos) : pos;
+  CCPoint world_pos = absolute ? pos : node->convertToWorldSpace(pos);
+
+  float height = 0;
+  if (headless_) {
+    // There is no GL context to load the image into so its size comes
+    // from its header (see util.GetPngSize).
+    if (!image_size_index_)
+      luaL_error(L_, "no image_size function to measure %s", image);
+    lua_pushvalue(L_, image_size_index_);
+    lua_pushstring(L_, image);
+    lua_call(L_, 1, 2);
+    height = lua_tonumber(L_, -1);
+    lua_pop(L_, 2);
+  } else {
+    CCSprite* sprite = CCSprite::create(image);
+    if (!sprite)
+      luaL_error(L_, "could not load image: %s", image);
+    sprite->setPosition(rel_pos);
+    node->addChild(sprite);
+    height = sprite->boundingBox().size.height;
+  }
+  AddCircle(node, world_pos, height / 2, GetBool(index, "sensor"));
+}
+
+void LevelBuilder::AddCircle(PhysicsNode* node, const CCPoint& location,
+                             float radius, bool sensor) {
+  b2Body* body = node->getB2Body();
+  b2CircleShape circle;
+  circle.m_radius = radius / ptm_ratio_;
+  circle.m_p.Set(location.x / ptm_ratio_ - body->GetPosition().x,
+                 location.y / ptm_ratio_ - body->GetPosition().y);
+  AddFixture(node, &circle, sensor);
+}
+
+void LevelBuilder::CreatePivot(const CCPoint& anchor, b2Body* body) {
+  b2Vec2 anchor_point(anchor.x / ptm_ratio_, anchor.y / ptm_ratio_);
+
+  // A fixed body for the shape to pivot against.
+  b2BodyDef ground_def;
+  ground_def.position = anchor_point;
+  b2World* world = layer_->GetWorld();
+  b2Body* ground_body = world->CreateBody(&ground_def);
+
+  b2RevoluteJointDef joint_def;
+  joint_def.Initialize(ground_body, body, anchor_point);
+  world->CreateJoint(&joint_def);
+}
+
+CCPoint LevelBuilder::GetPoint(int index, const char* key, bool absolute) {
+  lua_getfield(L_, index, key);
+  if (!lua_istable(L_, -1))
+    luaL_error(L_, "shape is missing '%s'", key);
+  lua_rawgeti(L_, -1, 1);
+  lua_rawgeti(L_, -2, 2);
+  CCPoint point = ccp(lua_tonumber(L_, -2), lua_tonumber(L_, -1));
+  lua_pop(L_, 3);
+  // Absolute positions are relative to the visible origin.
+  if (absolute)
+    point = ccpAdd(point, origin_);
+  return point;
+}
+
+bool LevelBuilder::GetBool(int index, const char* key) {
+  lua_getfield(L_, index, key);
+  bool value = lua_toboolean(L_, -1);
+  lua_pop(L_, 1);
+  return value;
+}
+
+ccColor3B LevelBuilder::GetColor(int index) {
+  ccColor3B color = ccc3(255, 255, 255);
+  lua_getfield(L_, index, "color");
+  if (lua_istable(L_, -1)) {
+    lua_rawgeti(L_, -1, 1);
+    lua_rawgeti(L_, -2, 2);
+    lua_rawgeti(L_, -3, 3);
+    color = ccc3(lua_tointeger(L_, -3), lua_tointeger(L_, -2),
+                 lua_tointeger(L_, -1));
+    lua_pop(L_, 3);
+  }
+  lua_pop(L_, 1);
+  return color;
+}
+
+const char* LevelBuilder::GetImage(int index) {
+  lua_getfield(L_, index, "image");
+  const char* name = lua_tostring(L_, -1);
+  if (!name)
+    luaL_error(L_, "shape is missing 'image'");
+  const char* filename = NULL;
+  if (assets_index_) {
+    lua_getfield(L_, assets_index_, name);
+    filename = lua_tostring(L_, -1);
+    lua_pop(L_, 1);
+  }
+  if (!filename)
+    luaL_error(L_, "unknown image: %s", name);
+  lua_pop(L_, 1);
+  // The string stays alive as it is still referenced by the assets.
+  return filename;
+}
+
+// Return a number from the options table at stack index 3.
+static float GetOption(lua_State* L, const char* key) {
+  lua_getfield(L, 3, key);
+  if (!lua_isnumber(L, -1))
+    luaL_error(L, "levelbuilder option '%s' must be a number", key);
+  float value = lua_tonumber(L, -1);
+  lua_pop(L, 1);
+  return value;
+}
+
+// Check the arguments common to all levelbuilder functions, which are
+// (layer, shapes, options), and return the layer.
+static LevelLayer* GetLayer(lua_State* L) {
+  tolua_Error error;
+  if (!tolua_isusertype(L, 1, "LevelLayer", 0, &error))
+    luaL_typerror(L, 1, "LevelLayer");
+  luaL_checktype(L, 2, LUA_TTABLE);
+  luaL_checktype(L, 3, LUA_TTABLE);
+  lua_settop(L, 3);
+  return static_cast<LevelLayer*>(tolua_tousertype(L, 1, 0));
+}
+
+// Configure 'builder' from the options table.  Values that the builder
+// refers to by stack index are left on the stack.
+static void ApplyOptions(lua_State* L, LevelBuilder* builder) {
+  // The scale and material come from the lua code that creates other
+  // bodies (util.PTM_RATIO and drawing.lua) so that the two agree.
+  builder->SetPTMRatio(GetOption(L, "ptm_ratio"));
+  builder->SetStrokeTag(GetOption(L, "stroke_tag"));
+  lua_getfield(L, 3, "material");
+  if (!lua_istable(L, -1))
+    luaL_error(L, "levelbuilder option 'material' must be a table");
+  lua_getfield(L, -1, "density");
+  lua_getfield(L, -2, "friction");
+  lua_getfield(L, -3, "restitution");
+  builder->SetMaterial(lua_tonumber(L, -3), lua_tonumber(L, -2),
+                       lua_tonumber(L, -1));
+  lua_pop(L, 4);
+
+  lua_getfield(L, 3, "brush");
+  lua_getfield(L, 3, "static_brush");
+  lua_getfield(L, 3, "brush_thickness");
+  builder->SetBrush(static_cast<StrokeBatch*>(tolua_tousertype(L, -3, 0)),
+                    static_cast<StrokeBatch*>(tolua_tousertype(L, -2, 0)),
+                    lua_tonumber(L, -1));
+  lua_pop(L, 3);
+  lua_getfield(L, 3, "headless");
+  builder->SetHeadless(lua_toboolean(L, -1));
+  lua_pop(L, 1);
+  lua_getfield(L, 3, "assets");
+  if (lua_istable(L, -1))
+    builder->SetAssets(lua_gettop(L));
+  lua_getfield(L, 3, "image_size");
+  if (lua_isfunction(L, -1))
+    builder->SetImageSizeFunction(lua_gettop(L));
+}
+
+static int Build(lua_State* L) {
+  LevelBuilder builder(L, GetLayer(L));
+  ApplyOptions(L, &builder);
+  lua_getfield(L, 3, "first_tag");
+  int first_tag = lua_isnumber(L, -1) ? lua_tointeger(L, -1) : 1;
+  lua_pop(L, 1);
+
+  builder.Build(2, first_tag);
+  return 2;
+}
+
+static int CreateShape(lua_State* L) {
+  LevelBuilder builder(L, GetLayer(L));
+  ApplyOptions(L, &builder);
+  PhysicsNode* node = builder.BuildShape(2, false);
+  if (!node)
+    return 0;
+  toluafix_pushusertype_ccobject(L, node->m_uID, &node->m_nLuaID, node,
+                                 "PhysicsNode");
+  return 1;
+}
+
+static const luaL_Reg levelbuilder_functions[] = {
+  { "build", Build },
+  { "create_shape", CreateShape },
+  { NULL, NULL }
+};
+
+int luaopen_levelbuilder(lua_State* L) {
+  luaL_register(L, "levelbuilder", levelbuilder_functions);
+  return 1;
+}
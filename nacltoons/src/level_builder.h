@@ -0,0 +1,137 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef LEVEL_BUILDER_H_
+#define LEVEL_BUILDER_H_
+
+#include <vector>
+
+#include "cocos2d.h"
+#include "Box2D/Box2D.h"
+
+USING_NS_CC;
+
+struct lua_State;
+class LevelLayer;
+class PhysicsNode;
+class StrokeBatch;
+class StrokeNode;
+
+/**
+ * Creates the bodies, fixtures, pivots, sprites and brush strokes for
+ * the shapes of a level from their shape defs in one native pass,
+ * rather than through a tolua call per object.  Shape defs have the
+ * same meaning as in drawing.CreateShape: 'compound', 'line', 'edge'
+ * and 'image' shapes with optional 'anchor', 'sensor' and 'dynamic'.
+ *
+ * This is exposed to lua by luaopen_levelbuilder as:
+ *
+ *   tag_map, objects = levelbuilder.build(layer, shapes, options)
+ *   node = levelbuilder.create_shape(layer, shape_def, options)
+ *
+ * where 'shapes' is a (possibly nested) list of shape defs.  build
+ * gives each shape def a tag, a tag_str and (except for edges) a node.
+ * 'tag_map' maps tag strings to tags and 'objects' lists the shape defs
+ * in tag order.  create_shape builds a single shape def, which must
+ * already have its tag.
+ *
+ * Shapes that can never change on screen are drawn into the layer's
+ * static cache (see LevelLayer::AddStaticNode).  Those are the shapes
+ * built by build that aren't dynamic and have no sensor, script or
+ * tag, since scripts find and animate shapes by their tags (such as
+ * fading out collected stars).  Shapes from create_shape are never
+ * cached.
+ *
+ * 'options' holds ptm_ratio, stroke_tag, material (density, friction
+ * and restitution), headless, brush, static_brush, brush_thickness,
+ * assets, image_size (a function returning the width and height of an
+ * image file, used in headless mode) and, for build, first_tag.  These
+ * are supplied by drawing.lua so that the values used by lua and by the
+ * builder can't drift apart.
+ */
+class LevelBuilder {
+ public:
+  LevelBuilder(lua_State* L, LevelLayer* layer);
+
+  // Brush used for the strokes of dynamic and static shapes.  With no
+  // brush (or in headless mode) no strokes are drawn.
+  void SetBrush(StrokeBatch* brush, StrokeBatch* static_brush,
+                float thickness);
+  void SetHeadless(bool headless) { headless_ = headless; }
+
+  // Stack index of the table mapping image names to filenames.
+  void SetAssets(int index) { assets_index_ = index; }
+
+  // Stack index of the function used to measure images in headless
+  // mode.
+  void SetImageSizeFunction(int index) { image_size_index_ = index; }
+
+  // Scale between points and box2d units.
+  void SetPTMRatio(float ptm_ratio) { ptm_ratio_ = ptm_ratio; }
+
+  // Tag given to the StrokeNode child of each shape.
+  void SetStrokeTag(int tag) { stroke_tag_ = tag; }
+
+  // Material used for every fixture.
+  void SetMaterial(float density, float friction, float restitution);
+
+  // Tag and register every shape def in the list at 'shapes_index'
+  // and build them.  Pushes the tag map and the list of shape defs.
+  // Errors in the shape defs are raised as lua errors.
+  void Build(int shapes_index, int first_tag);
+
+  // Build the (already tagged) shape def at 'index', returning its node
+  // (if any).  Strokes of cacheable shapes go in the static brush.
+  PhysicsNode* BuildShape(int index, bool cacheable);
+
+ private:
+  // Tag the shape defs in a list, adding them to the tag map and
+  // object list at the given stack indexes.
+  void CollectShapes(int list_index, int tag_map_index, int objects_index,
+                     int* next_tag);
+
+  // Returns true if the untagged shape def at 'index' can be drawn
+  // into the static cache.
+  bool IsCacheable(int index);
+
+  void AddChildShape(PhysicsNode* node, StrokeNode* stroke, int index,
+                     bool absolute);
+
+  PhysicsNode* CreatePhysicsNode(const CCPoint& location, bool dynamic,
+                                 int tag);
+  StrokeNode* CreateStrokeNode(PhysicsNode* parent, bool is_static);
+  b2Fixture* AddFixture(PhysicsNode* node, b2Shape* shape, bool sensor);
+  void AddLine(PhysicsNode* node, StrokeNode* stroke, const CCPoint& from,
+               const CCPoint& to, const ccColor3B& color, bool absolute);
+  void AddSprite(PhysicsNode* node, int index, bool absolute);
+  void AddCircle(PhysicsNode* node, const CCPoint& location, float radius,
+                 bool sensor);
+  void CreatePivot(const CCPoint& anchor, b2Body* body);
+
+  // Accessors for fields of the shape def at 'index'.
+  CCPoint GetPoint(int index, const char* key, bool absolute);
+  bool GetBool(int index, const char* key);
+  ccColor3B GetColor(int index);
+  const char* GetImage(int index);
+
+  lua_State* L_;
+  LevelLayer* layer_;
+  StrokeBatch* brush_;
+  StrokeBatch* static_brush_;
+  float thickness_;
+  bool headless_;
+  int assets_index_;
+  int image_size_index_;
+  float ptm_ratio_;
+  int stroke_tag_;
+  // Fixture def holding the material, copied for each fixture.
+  b2FixtureDef material_;
+  // Offset applied to absolute positions.
+  CCPoint origin_;
+  // Whether each shape collected by Build is cacheable, in tag order.
+  std::vector<bool> cacheable_;
+};
+
+int luaopen_levelbuilder(lua_State* L);
+
+#endif  // LEVEL_BUILDER_H_
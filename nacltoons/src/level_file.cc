@@ -0,0 +1,360 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "level_file.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+#include <vector>
+
+extern "C" {
+#include "lua.h"
+#include "lauxlib.h"
+}
+
+#define LEVEL_FILE_MAGIC "NTLV"
+#define LEVEL_FILE_VERSION 2
+
+// Limit on how deeply tables can be nested, which bounds the amount
+// of lua stack (and C stack) a corrupt file can use.
+#define MAX_DEPTH 64
+
+// Contents of a file, memory mapped where the platform supports it
+// and read into memory otherwise.
+class FileData {
+ public:
+  FileData() : data_(NULL), size_(0), mapped_(false) {}
+  ~FileData();
+
+  bool Open(const char* filename);
+  const char* data() { return data_; }
+  size_t size() { return size_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+  bool mapped_;
+  std::vector<char> buffer_;
+};
+
+FileData::~FileData() {
+#ifndef WIN32
+  if (mapped_)
+    munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+bool FileData::Open(const char* filename) {
+  FILE* file = fopen(filename, "rb");
+  if (!file)
+    return false;
+  struct stat st;
+  if (fstat(fileno(file), &st) != 0) {
+    fclose(file);
+    return false;
+  }
+  size_ = st.st_size;
+
+#ifndef WIN32
+  if (size_) {
+    void* map = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (map != MAP_FAILED) {
+      fclose(file);
+      data_ = static_cast<const char*>(map);
+      mapped_ = true;
+      return true;
+    }
+  }
+#endif
+
+  // Fall back to reading the whole file.
+  buffer_.resize(size_);
+  bool ok = !size_ || fread(&buffer_[0], 1, size_, file) == size_;
+  fclose(file);
+  data_ = size_ ? &buffer_[0] : NULL;
+  return ok;
+}
+
+// Adler-32 checksum, as computed by compile.lua.
+static uint32_t Checksum(const char* data, size_t size) {
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (size_t i = 0; i < size; i++) {
+    a = (a + static_cast<uint8_t>(data[i])) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+// Decodes a level file, pushing the values it contains onto the lua
+// stack.  On failure error() describes the problem and the stack may
+// hold partially built tables.
+class Reader {
+ public:
+  Reader(lua_State* L, const char* data, size_t size, int null_index) :
+      L_(L),
+      pos_(data),
+      end_(data + size),
+      null_index_(null_index),
+      error_(NULL),
+      source_size_(0),
+      source_checksum_(0) {
+  }
+
+  // Read the header, which records the size and checksum of the
+  // .def file that the level was compiled from.
+  bool ReadHeader();
+  // Push the value stored in the file.
+  bool Read();
+  const char* error() { return error_; }
+  uint32_t source_size() { return source_size_; }
+  uint32_t source_checksum() { return source_checksum_; }
+
+ private:
+  bool Fail(const char* error) {
+    error_ = error;
+    return false;
+  }
+
+  size_t Remaining() { return end_ - pos_; }
+  bool ReadByte(uint8_t* value);
+  bool ReadUint32(uint32_t* value);
+  bool PushValue(int depth);
+  bool PushTable(int depth);
+
+  lua_State* L_;
+  const char* pos_;
+  const char* end_;
+  // Stack index of the value that nulls are loaded as.
+  int null_index_;
+  const char* error_;
+  uint32_t source_size_;
+  uint32_t source_checksum_;
+};
+
+bool Reader::ReadHeader() {
+  size_t magic_length = strlen(LEVEL_FILE_MAGIC);
+  if (Remaining() < magic_length + 1 ||
+      memcmp(pos_, LEVEL_FILE_MAGIC, magic_length) != 0)
+    return Fail("not a compiled level file");
+  pos_ += magic_length;
+  uint8_t version;
+  ReadByte(&version);
+  if (version != LEVEL_FILE_VERSION)
+    return Fail("unsupported level file version");
+  return ReadUint32(&source_size_) && ReadUint32(&source_checksum_);
+}
+
+bool Reader::Read() {
+  if (!PushValue(0))
+    return false;
+  if (pos_ != end_)
+    return Fail("unexpected data after end of level");
+  return true;
+}
+
+bool Reader::ReadByte(uint8_t* value) {
+  if (Remaining() < 1)
+    return Fail("unexpected end of file");
+  *value = *pos_++;
+  return true;
+}
+
+bool Reader::ReadUint32(uint32_t* value) {
+  if (Remaining() < 4)
+    return Fail("unexpected end of file");
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(pos_);
+  *value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+           (static_cast<uint32_t>(bytes[3]) << 24);
+  pos_ += 4;
+  return true;
+}
+
+bool Reader::PushValue(int depth) {
+  uint8_t tag;
+  if (!ReadByte(&tag))
+    return false;
+
+  switch (tag) {
+    case 'F':
+    case 'T':
+      lua_pushboolean(L_, tag == 'T');
+      return true;
+    case 'N':
+      lua_pushvalue(L_, null_index_);
+      return true;
+    case 'i': {
+      uint32_t value;
+      if (!ReadUint32(&value))
+        return false;
+      lua_pushnumber(L_, static_cast<int32_t>(value));
+      return true;
+    }
+    case 'd': {
+      uint8_t length;
+      if (!ReadByte(&length))
+        return false;
+      if (Remaining() < length)
+        return Fail("unexpected end of file");
+      char text[256];
+      memcpy(text, pos_, length);
+      text[length] = '\0';
+      pos_ += length;
+      char* end;
+      double value = strtod(text, &end);
+      if (!length || end != text + length)
+        return Fail("invalid number");
+      lua_pushnumber(L_, value);
+      return true;
+    }
+    case 's': {
+      uint32_t length;
+      if (!ReadUint32(&length))
+        return false;
+      if (Remaining() < length)
+        return Fail("unexpected end of file");
+      lua_pushlstring(L_, pos_, length);
+      pos_ += length;
+      return true;
+    }
+    case 't':
+      return PushTable(depth + 1);
+    default:
+      return Fail("unknown value type");
+  }
+}
+
+bool Reader::PushTable(int depth) {
+  if (depth > MAX_DEPTH)
+    return Fail("tables nested too deeply");
+  uint32_t array_count;
+  uint32_t key_count;
+  if (!ReadUint32(&array_count) || !ReadUint32(&key_count))
+    return false;
+  // Every value takes at least one byte, which stops a corrupt file
+  // from making us allocate huge tables.
+  if (array_count > Remaining() || key_count > Remaining() / 2)
+    return Fail("unexpected end of file");
+  if (!lua_checkstack(L_, 3))
+    return Fail("out of stack space");
+
+  // The sizes are known up front so the table is never rehashed.
+  lua_createtable(L_, array_count, key_count);
+  for (uint32_t i = 1; i <= array_count; i++) {
+    if (!PushValue(depth))
+      return false;
+    lua_rawseti(L_, -2, i);
+  }
+  for (uint32_t i = 0; i < key_count; i++) {
+    if (!PushValue(depth) || !PushValue(depth))
+      return false;
+    if (lua_isnumber(L_, -2) && lua_tonumber(L_, -2) != lua_tonumber(L_, -2))
+      return Fail("invalid table key");
+    lua_rawset(L_, -3);
+  }
+  return true;
+}
+
+// Stack slots used while loading.
+#define SOURCE_INDEX 2
+#define NULL_INDEX 3
+
+static int Load(lua_State* L) {
+  const char* filename = luaL_checkstring(L, 1);
+  const char* source = luaL_optstring(L, SOURCE_INDEX, NULL);
+  lua_settop(L, SOURCE_INDEX);
+
+  // Nulls are loaded as yaml.null, as lua-yaml does.
+  lua_getglobal(L, "package");
+  lua_getfield(L, -1, "loaded");
+  lua_getfield(L, -1, "yaml");
+  if (lua_istable(L, -1))
+    lua_getfield(L, -1, "null");
+  else
+    lua_pushnil(L);
+  lua_replace(L, NULL_INDEX);
+  lua_settop(L, NULL_INDEX);
+
+  const char* error = NULL;
+  bool up_to_date = true;
+  {
+    // Scoped so that the files are closed before luaL_error, which
+    // doesn't return.
+    FileData file;
+    if (!file.Open(filename)) {
+      error = "could not read file";
+    } else {
+      Reader reader(L, file.data(), file.size(), NULL_INDEX);
+      if (!reader.ReadHeader()) {
+        error = reader.error();
+      } else if (source) {
+        FileData source_file;
+        up_to_date = source_file.Open(source) &&
+            source_file.size() == reader.source_size() &&
+            Checksum(source_file.data(), source_file.size()) ==
+                reader.source_checksum();
+      }
+      if (!error && up_to_date && !reader.Read())
+        error = reader.error();
+    }
+  }
+
+  if (error) {
+    lua_settop(L, NULL_INDEX);
+    return luaL_error(L, "Error in '%s': %s", filename, error);
+  }
+  if (!up_to_date)
+    lua_pushnil(L);
+  return 1;
+}
+
+static int ModificationTime(lua_State* L) {
+  const char* filename = luaL_checkstring(L, 1);
+  struct stat st;
+  if (stat(filename, &st) != 0)
+    lua_pushnil(L);
+  else
+    lua_pushnumber(L, st.st_mtime);
+  return 1;
+}
+
+static int Stamp(lua_State* L) {
+  const char* filename = luaL_checkstring(L, 1);
+  struct stat st;
+  if (stat(filename, &st) != 0) {
+    lua_pushnil(L);
+    return 1;
+  }
+  // Whole seconds aren't enough to tell apart edits made in quick
+  // succession, so use nanoseconds where they are available and
+  // include the size.
+  long nsec = 0;
+#if defined(__linux__)
+  nsec = st.st_mtim.tv_nsec;
+#endif
+  char stamp[64];
+  snprintf(stamp, sizeof(stamp), "%ld.%09ld:%ld",
+           static_cast<long>(st.st_mtime), nsec,
+           static_cast<long>(st.st_size));
+  lua_pushstring(L, stamp);
+  return 1;
+}
+
+static const luaL_Reg levelfile_functions[] = {
+  { "load", Load },
+  { "mtime", ModificationTime },
+  { "stamp", Stamp },
+  { NULL, NULL }
+};
+
+int luaopen_levelfile(lua_State* L) {
+  luaL_register(L, "levelfile", levelfile_functions);
+  return 1;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef LEVEL_FILE_H_
+#define LEVEL_FILE_H_
+
+struct lua_State;
+
+/**
+ * Registers the 'levelfile' lua module which loads .bin files written
+ * by compile.lua.  These hold the same tables as the .def files they
+ * were compiled from, so loading one replaces yaml parsing with a
+ * single pass over a memory mapped buffer:
+ *
+ *   levelfile.load(filename [, source])
+ *                              returns the table stored in filename.  If
+ *                              'source' is given and isn't the file
+ *                              that filename was compiled from (i.e.
+ *                              it has been edited since) returns nil
+ *   levelfile.mtime(filename)  returns the modification time of
+ *                              filename, or nil if it does not exist
+ *   levelfile.stamp(filename)  returns a string that changes whenever
+ *                              filename is modified (its modification
+ *                              time, to the nanosecond where possible,
+ *                              and size), or nil if it does not exist
+ *
+ * The format (all integers are little endian):
+ *
+ *   header:  "NTLV", a one byte format version, then the size and
+ *            Adler-32 checksum of the source .def file as uint32s
+ *   value:   one byte type tag followed by its payload
+ *     'F', 'T'   false, true (no payload)
+ *     'N'        null (no payload), loaded as yaml.null
+ *     'i'        integral number as an int32
+ *     'd'        other number as a one byte length and %.17g text
+ *     's'        string as a uint32 length and its bytes
+ *     't'        table as a uint32 array length and uint32 number of
+ *                other keys, then the array values and the key/value
+ *                pairs
+ */
+int luaopen_levelfile(lua_State* L);
+
+#endif  // LEVEL_FILE_H_
@@ -4,9 +4,13 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+
 #include "level_layer.h"
 #include "app_delegate.h"
 #include "game_manager.h"
+#include "physics_node.h"
+#include "stroke_batch.h"
 
 #include "physics_nodes/CCPhysicsSprite.h"
 #include "CCLuaEngine.h"
@@ -23,40 +27,170 @@ extern "C" {
 // to Box2D "meters".
 #define PTM_RATIO 32
 
+// Fixed timestep used to advance the Box2D world.
+#define PHYSICS_TIMESTEP (1.0f / 60.0f)
+
+// Maximum number of fixed timesteps taken in a single frame.  Any
+// time beyond this is dropped so that a slow frame does not cause
+// an ever increasing amount of physics work.
+#define MAX_PHYSICS_SUBSTEPS 5
+
+// Number of physics steps kept by the profiler.
+#define PROFILE_SAMPLES 256
+
+// Size of the profile graph drawn in debug mode.
+#define PROFILE_GRAPH_WIDTH 256
+#define PROFILE_GRAPH_HEIGHT 80
+
+#define VELOCITY_ITERATIONS 8
+#define POSITION_ITERATIONS 1
+
+// Seconds between checks for idleness (the frame rate is lowered if
+// the layer is idle when checked), and the frame interval used once
+// it is.
+#define IDLE_DELAY 1.0f
+#define IDLE_ANIMATION_INTERVAL (1.0 / 10)
+
+// Distance (in points) outside the view within which bodies are still
+// drawn, so that nodes don't pop in at the edges of the screen.
+#define CULL_MARGIN 64.0f
+
+// Size of the static cache of a scrollable level relative to the view.
+#define STATIC_CACHE_SCALE 2.0f
+
 USING_NS_CC_EXT;
 
-class Box2DCallbackHandler : public b2QueryCallback
-{
+/**
+ * Collects the bodies found by b2World::QueryAABB, reporting each body
+ * once.  Fixtures are first filtered by category and then tested
+ * against the exact query shape (point, box or circle).
+ */
+class BodyQueryCallback : public b2QueryCallback {
  public:
-  Box2DCallbackHandler(b2Vec2* test_point, CCLuaStack* lua_stack,
-                       int lua_handler) :
-     test_point_(*test_point),
-     lua_handler_(lua_handler),
-     lua_stack_(lua_stack) {}
-
-  // Called by box2d when doing AABB testing to find bodies.
-  bool ReportFixture(b2Fixture* fixture)
-  {
-    if (fixture->TestPoint(test_point_)) {
-      b2Body* body = fixture->GetBody();
-      lua_stack_->pushUserType(body, "b2Body");
-      lua_stack_->executeFunctionByHandler(lua_handler_, 1);
-    }
+  enum QueryType { QUERY_POINT, QUERY_AABB, QUERY_RADIUS };
+
+  BodyQueryCallback(QueryType type, uint16 mask) :
+      type_(type),
+      mask_(mask) {}
 
+  void SetPoint(const b2Vec2& point) { point_ = point; }
+  void SetAABB(const b2AABB& aabb) { aabb_ = aabb; }
+  void SetCircle(const b2Vec2& center, float radius) {
+    circle_.m_p = center;
+    circle_.m_radius = radius;
+  }
+
+  const std::vector<b2Body*>& bodies() { return bodies_; }
+
+  bool ReportFixture(b2Fixture* fixture) {
+    if (!(fixture->GetFilterData().categoryBits & mask_))
+      return true;
+    b2Body* body = fixture->GetBody();
+    if (found_.count(body))
+      return true;
+    if (!Matches(fixture))
+      return true;
+    found_.insert(body);
+    bodies_.push_back(body);
     return true; // keep looking
   }
 
- protected:
-  // Used by b2QueryCallback to find bodies as a given location
-  b2Vec2 test_point_;
-  int lua_handler_;
-  CCLuaStack* lua_stack_;
+ private:
+  bool Matches(b2Fixture* fixture) {
+    switch (type_) {
+      case QUERY_POINT:
+        return fixture->TestPoint(point_);
+      case QUERY_AABB:
+        for (int i = 0; i < fixture->GetShape()->GetChildCount(); i++) {
+          if (b2TestOverlap(fixture->GetAABB(i), aabb_))
+            return true;
+        }
+        return false;
+      case QUERY_RADIUS: {
+        b2Transform identity;
+        identity.SetIdentity();
+        const b2Transform& xf = fixture->GetBody()->GetTransform();
+        for (int i = 0; i < fixture->GetShape()->GetChildCount(); i++) {
+          if (b2TestOverlap(fixture->GetShape(), i, &circle_, 0, xf,
+                            identity))
+            return true;
+        }
+        return false;
+      }
+    }
+    return false;
+  }
+
+  QueryType type_;
+  uint16 mask_;
+  b2Vec2 point_;
+  b2AABB aabb_;
+  b2CircleShape circle_;
+  std::set<b2Body*> found_;
+  std::vector<b2Body*> bodies_;
 };
 
+/**
+ * Collects the bodies crossed by a ray along with the fraction along
+ * the ray of the nearest hit on each body.
+ */
+class BodyRayCastCallback : public b2RayCastCallback {
+ public:
+  explicit BodyRayCastCallback(uint16 mask) : mask_(mask) {}
+
+  float32 ReportFixture(b2Fixture* fixture, const b2Vec2& point,
+                        const b2Vec2& normal, float32 fraction) {
+    if (!(fixture->GetFilterData().categoryBits & mask_))
+      return -1; // ignore this fixture
+    b2Body* body = fixture->GetBody();
+    std::map<b2Body*, float>::iterator it = hits_.find(body);
+    if (it == hits_.end())
+      hits_[body] = fraction;
+    else if (fraction < it->second)
+      it->second = fraction;
+    return 1; // keep looking
+  }
+
+  // Return the hits sorted by fraction.
+  void GetHits(std::vector<b2Body*>* bodies, std::vector<float>* fractions) {
+    std::vector<std::pair<float, b2Body*> > sorted;
+    std::map<b2Body*, float>::iterator it;
+    for (it = hits_.begin(); it != hits_.end(); ++it)
+      sorted.push_back(std::make_pair(it->second, it->first));
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); i++) {
+      fractions->push_back(sorted[i].first);
+      bodies->push_back(sorted[i].second);
+    }
+  }
+
+ private:
+  uint16 mask_;
+  std::map<b2Body*, float> hits_;
+};
+
+LevelLayer* LevelLayer::createHeadless() {
+  LevelLayer* layer = new LevelLayer();
+  layer->headless_ = true;
+  if (!layer->init()) {
+    delete layer;
+    return NULL;
+  }
+  layer->autorelease();
+  return layer;
+}
+
 bool LevelLayer::init() {
-  if (!CCLayerColor::initWithColor(ccc4(0,0x8F,0xD8,0xD8)))
+  if (headless_) {
+    // CCLayerColor::init would create shaders, which needs GL.
+    if (!CCLayer::init())
+      return false;
+  } else if (!CCLayerColor::initWithColor(ccc4(0,0x8F,0xD8,0xD8))) {
     return false;
+  }
 
+  CCSize size = CCDirector::sharedDirector()->getVisibleSize();
+  level_bounds_ = CCRect(0, 0, size.width, size.height);
   InitPhysics();
   return true;
 }
@@ -65,20 +199,38 @@ bool LevelLayer::LoadLevel(int level_number) {
   // Load level from lua file.
   LoadLua(level_number);
   CCLog("loaded level");
-  setTouchEnabled(true);
+  if (!headless_)
+    setTouchEnabled(true);
+  schedule(schedule_selector(LevelLayer::UpdatePhysics));
   return true;
 }
 
-LevelLayer::LevelLayer() : debug_enabled_(false) {
+LevelLayer::LevelLayer() :
+    box2d_world_(NULL),
+    box2d_debug_draw_(NULL),
+    debug_enabled_(false),
+    headless_(false),
+    physics_enabled_(true),
+    physics_accumulator_(0),
+    physics_substeps_(0),
+    dropped_physics_time_(0),
+    idle_throttling_(true),
+    throttled_(false),
+    resuming_(false),
+    idle_time_(0),
+    throttled_time_(0),
+    normal_animation_interval_(0),
+    static_cache_(NULL),
+    static_cache_dirty_(false),
+    camera_target_(NULL),
+    reset_culling_(true),
+    physics_profiler_(PROFILE_SAMPLES) {
 }
 
 LevelLayer::~LevelLayer() {
   delete box2d_world_;
-#ifdef COCOS2D_DEBUG
-#ifndef WIN32
   delete box2d_debug_draw_;
-#endif
-#endif
+  CC_SAFE_RELEASE(static_cache_);
 }
 
 bool LevelLayer::LoadLua(int level_number) {
@@ -106,25 +258,237 @@ bool LevelLayer::InitPhysics() {
   box2d_world_->SetContinuousPhysics(true);
   box2d_world_->SetContactListener(this);
 
-#ifdef COCOS2D_DEBUG
-#ifndef WIN32
-  box2d_debug_draw_ = new GLESDebugDraw(PTM_RATIO);
+  // DebugDraw needs the shader cache.
+  if (headless_)
+    return true;
+
+  box2d_debug_draw_ = new DebugDraw(PTM_RATIO);
   box2d_world_->SetDebugDraw(box2d_debug_draw_);
 
   uint32 flags = 0;
   flags += b2Draw::e_shapeBit;
   flags += b2Draw::e_jointBit;
   flags += b2Draw::e_centerOfMassBit;
-  //flags += b2Draw::e_aabbBit;
-  //flags += b2Draw::e_pairBit;
   box2d_debug_draw_->SetFlags(flags);
-#endif
-#endif
   return true;
 }
 
+void LevelLayer::addChild(CCNode* child, int z_order, int tag) {
+  CCLayerColor::addChild(child, z_order, tag);
+  PhysicsNode* node = dynamic_cast<PhysicsNode*>(child);
+  if (node && node->getB2Body()) {
+    physics_nodes_[node->getB2Body()] = node;
+    // Make sure new nodes get drawn at least once at their body's
+    // current position even if the body is asleep or static.
+    node->Interpolate(1.0f);
+    // New nodes are visible; the next UpdateCulling hides them if
+    // they are out of view.
+    nodes_in_view_.insert(node);
+  }
+}
+
+void LevelLayer::removeChild(CCNode* child, bool cleanup) {
+  PhysicsNode* node = dynamic_cast<PhysicsNode*>(child);
+  if (node) {
+    PhysicsNodeMap::iterator it = physics_nodes_.find(node->getB2Body());
+    if (it != physics_nodes_.end() && it->second == node)
+      physics_nodes_.erase(it);
+    moving_nodes_.erase(
+        std::remove(moving_nodes_.begin(), moving_nodes_.end(), node),
+        moving_nodes_.end());
+    nodes_in_view_.erase(node);
+  }
+  if (child == camera_target_)
+    camera_target_ = NULL;
+  RemoveStaticNode(child);
+  CCLayerColor::removeChild(child, cleanup);
+}
+
+void LevelLayer::removeAllChildrenWithCleanup(bool cleanup) {
+  physics_nodes_.clear();
+  moving_nodes_.clear();
+  static_nodes_.clear();
+  static_cache_dirty_ = true;
+  nodes_in_view_.clear();
+  camera_target_ = NULL;
+  CCLayerColor::removeAllChildrenWithCleanup(cleanup);
+}
+
+PhysicsNode* LevelLayer::GetPhysicsNode(b2Body* body) {
+  PhysicsNodeMap::iterator it = physics_nodes_.find(body);
+  if (it == physics_nodes_.end())
+    return NULL;
+  return it->second;
+}
+
+void LevelLayer::SetPhysicsEnabled(bool enabled) {
+  Wake();
+  physics_enabled_ = enabled;
+  physics_accumulator_ = 0;
+  // Draw all nodes at their current position until stepping resumes.
+  InterpolatePhysicsNodes(1.0f);
+}
+
+void LevelLayer::SetIdleThrottling(bool enabled) {
+  idle_throttling_ = enabled;
+  if (!enabled)
+    Wake();
+}
+
+void LevelLayer::Wake() {
+  idle_time_ = 0;
+  if (!throttled_)
+    return;
+  CCDirector::sharedDirector()->setAnimationInterval(
+      normal_animation_interval_);
+  throttled_ = false;
+  resuming_ = true;
+}
+
+bool LevelLayer::IsIdle() {
+  // Sleeping bodies are only woken by other bodies, joints or calls
+  // from scripts, all of which wake them via the body list.
+  for (b2Body* body = box2d_world_->GetBodyList(); body;
+       body = body->GetNext()) {
+    if (body->GetType() != b2_staticBody && body->IsAwake())
+      return false;
+  }
+
+  // Actions count wherever they run, including nodes outside the layer
+  // such as menus added to its parent.  The action manager can't count
+  // its actions, but pausing them all returns the nodes that have
+  // running actions, which are then resumed straight away.
+  CCActionManager* actions = CCDirector::sharedDirector()->getActionManager();
+  CCSet* targets = actions->pauseAllRunningActions();
+  actions->resumeTargets(targets);
+  return targets->count() == 0;
+}
+
+bool LevelLayer::UpdateIdleState(float dt) {
+  if (headless_ || !idle_throttling_)
+    return false;
+
+  // Throttled frames are far apart so each one checks whether to wake.
+  if (throttled_) {
+    if (!IsIdle()) {
+      Wake();
+      return false;
+    }
+    throttled_time_ += dt;
+    return true;
+  }
+
+  // At full speed the check is only made once per IDLE_DELAY so that
+  // its cost isn't paid every frame.
+  idle_time_ += dt;
+  if (idle_time_ < IDLE_DELAY)
+    return false;
+  idle_time_ = 0;
+  if (!IsIdle())
+    return false;
+
+  CCDirector* director = CCDirector::sharedDirector();
+  normal_animation_interval_ = director->getAnimationInterval();
+  director->setAnimationInterval(IDLE_ANIMATION_INTERVAL);
+  throttled_ = true;
+  return true;
+}
+
+void LevelLayer::UpdatePhysics(float dt) {
+  if (UpdateIdleState(dt)) {
+    // Nothing can move so there is no need to step the world.
+    DeliverContacts();
+    return;
+  }
+  if (resuming_) {
+    dt = MIN(dt, PHYSICS_TIMESTEP);
+    resuming_ = false;
+  }
+
+  if (!physics_enabled_) {
+    // Bodies can still be destroyed while paused (e.g. in the editor).
+    DeliverContacts();
+    UpdateCamera();
+    UpdateCulling();
+    return;
+  }
+
+  physics_accumulator_ += dt;
+  int steps = (int)(physics_accumulator_ / PHYSICS_TIMESTEP);
+  if (steps > MAX_PHYSICS_SUBSTEPS) {
+    float dropped = (steps - MAX_PHYSICS_SUBSTEPS) * PHYSICS_TIMESTEP;
+    dropped_physics_time_ += dropped;
+    physics_accumulator_ -= dropped;
+    steps = MAX_PHYSICS_SUBSTEPS;
+  }
+
+  for (int i = 0; i < steps; i++) {
+    // Only the state before the final step is needed for interpolation.
+    if (i == steps - 1)
+      SavePhysicsState();
+    box2d_world_->Step(PHYSICS_TIMESTEP, VELOCITY_ITERATIONS,
+                       POSITION_ITERATIONS);
+    physics_profiler_.Record(box2d_world_);
+    physics_accumulator_ -= PHYSICS_TIMESTEP;
+    physics_substeps_++;
+  }
+
+  DeliverContacts();
+  SyncPhysicsNodes(physics_accumulator_ / PHYSICS_TIMESTEP);
+  UpdateCamera();
+  UpdateCulling();
+}
+
+void LevelLayer::SavePhysicsState() {
+  for (b2Body* body = box2d_world_->GetBodyList(); body;
+       body = body->GetNext()) {
+    if (body->GetType() == b2_staticBody || !body->IsAwake())
+      continue;
+    PhysicsNode* node = GetPhysicsNode(body);
+    if (node)
+      node->SavePhysicsState();
+  }
+}
+
+void LevelLayer::SyncPhysicsNodes(float alpha) {
+  next_moving_nodes_.clear();
+  for (b2Body* body = box2d_world_->GetBodyList(); body;
+       body = body->GetNext()) {
+    if (body->GetType() == b2_staticBody || !body->IsAwake())
+      continue;
+    PhysicsNode* node = GetPhysicsNode(body);
+    if (!node)
+      continue;
+    node->Interpolate(alpha);
+    next_moving_nodes_.push_back(node);
+  }
+
+  // Bodies that went to sleep won't be visited again until they wake,
+  // so draw them at their final position and make that the state to
+  // interpolate from when they do.
+  std::vector<PhysicsNode*>::iterator it;
+  for (it = moving_nodes_.begin(); it != moving_nodes_.end(); ++it) {
+    b2Body* body = (*it)->getB2Body();
+    if (body->GetType() == b2_staticBody || !body->IsAwake()) {
+      (*it)->SavePhysicsState();
+      (*it)->Interpolate(1.0f);
+    }
+  }
+
+  moving_nodes_.swap(next_moving_nodes_);
+}
+
+void LevelLayer::InterpolatePhysicsNodes(float alpha) {
+  PhysicsNodeMap::iterator it;
+  for (it = physics_nodes_.begin(); it != physics_nodes_.end(); ++it)
+    it->second->Interpolate(alpha);
+}
+
 void LevelLayer::ToggleDebug() {
+  Wake();
   debug_enabled_ = !debug_enabled_;
+  // Visibility of all children is reset below, undoing any culling.
+  reset_culling_ = true;
 
   // Set visibility of all children based on debug_enabled_
   CCArray* children = getChildren();
@@ -137,6 +501,17 @@ void LevelLayer::ToggleDebug() {
   }
 }
 
+void LevelLayer::SetDebugDrawFlags(uint32 flags) {
+  if (box2d_debug_draw_)
+    box2d_debug_draw_->SetFlags(flags);
+}
+
+uint32 LevelLayer::GetDebugDrawFlags() {
+  if (!box2d_debug_draw_)
+    return 0;
+  return box2d_debug_draw_->GetFlags();
+}
+
 CCRect CalcBoundingBox(CCSprite* sprite) {
   CCSize size = sprite->getContentSize();
   CCPoint pos = sprite->getPosition();
@@ -144,17 +519,7 @@ CCRect CalcBoundingBox(CCSprite* sprite) {
                     size.width, size.height/2);
 }
 
-void LevelLayer::LuaNotifyContact(b2Contact* contact,
-                                    const char* function_name) {
-  // Return early if lua didn't define the function_name
-  lua_State* state = lua_stack_->getLuaState();
-  lua_getglobal(state, function_name);
-  bool is_func = lua_isfunction(state, -1);
-  lua_pop(state, 1);
-
-  if (!is_func)
-    return;
-
+void LevelLayer::LuaNotifyContact(b2Contact* contact, ContactKind kind) {
   // Only send to lua collitions between body's that
   // have been tagged.
   b2Body* body1 = contact->GetFixtureA()->GetBody();
@@ -164,47 +529,480 @@ void LevelLayer::LuaNotifyContact(b2Contact* contact,
   if (!tag1 || !tag2)
     return;
 
-  // Call the lua function callback passing in tags of the two bodies that
-  // collided
-  lua_stack_->pushInt(tag1);
-  lua_stack_->pushInt(tag2);
-  lua_stack_->executeFunctionByName(function_name, 2);
+  // Every tagged pair is counted, whatever the filters, so that the
+  // counts stay right when the filters change while bodies touch.
+  BodyPair pair = body1 < body2 ? BodyPair(body1, body2) :
+                                  BodyPair(body2, body1);
+  if (kind == CONTACT_BEGAN) {
+    BodyContact& body_contact = body_contacts_[pair];
+    if (body_contact.count++ > 0)
+      return;
+    body_contact.reported = IsContactWanted(tag1, tag2);
+    if (!body_contact.reported)
+      return;
+  } else {
+    std::map<BodyPair, BodyContact>::iterator it = body_contacts_.find(pair);
+    if (it == body_contacts_.end())
+      return;
+    if (--it->second.count > 0)
+      return;
+    bool reported = it->second.reported;
+    body_contacts_.erase(it);
+    // Ignore contacts that began before the pair was wanted.
+    if (!reported || !IsContactWanted(tag1, tag2))
+      return;
+  }
+
+  pending_contacts_.push_back(tag1);
+  pending_contacts_.push_back(tag2);
+  pending_contacts_.push_back(kind);
+}
+
+static std::pair<int, int> MakeTagPair(int tag1, int tag2) {
+  if (tag1 < tag2)
+    return std::make_pair(tag2, tag1);
+  return std::make_pair(tag1, tag2);
+}
+
+void LevelLayer::AddContactFilter(int tag1, int tag2) {
+  contact_filters_.insert(MakeTagPair(tag1, tag2));
+}
+
+void LevelLayer::ClearContactFilters() {
+  contact_filters_.clear();
+}
+
+bool LevelLayer::IsContactWanted(int tag1, int tag2) {
+  if (contact_filters_.empty())
+    return true;
+
+  std::set<TagPair>::const_iterator end = contact_filters_.end();
+  return contact_filters_.find(MakeTagPair(tag1, tag2)) != end ||
+         contact_filters_.find(MakeTagPair(tag1, 0)) != end ||
+         contact_filters_.find(MakeTagPair(tag2, 0)) != end ||
+         contact_filters_.find(MakeTagPair(0, 0)) != end;
+}
+
+void LevelLayer::DeliverContacts() {
+  if (pending_contacts_.empty())
+    return;
+
+  // Handlers can destroy bodies, which generates new EndContact calls,
+  // so take ownership of the current batch before calling into Lua.
+  // Contacts recorded during delivery are sent with the next batch.
+  std::vector<int> contacts;
+  contacts.swap(pending_contacts_);
+
+  // Return early if lua didn't define OnContacts
+  lua_State* state = lua_stack_->getLuaState();
+  lua_getglobal(state, "OnContacts");
+  bool is_func = lua_isfunction(state, -1);
+  lua_pop(state, 1);
+
+  if (!is_func)
+    return;
+
+  lua_createtable(state, contacts.size(), 0);
+  for (size_t i = 0; i < contacts.size(); i++) {
+    lua_pushinteger(state, contacts[i]);
+    lua_rawseti(state, -2, i + 1);
+  }
+  lua_stack_->executeFunctionByName("OnContacts", 1);
 }
 
 void LevelLayer::BeginContact(b2Contact* contact) {
-  LuaNotifyContact(contact, "OnContactBegan");
+  LuaNotifyContact(contact, CONTACT_BEGAN);
 }
 
 void LevelLayer::EndContact(b2Contact* contact) {
-  LuaNotifyContact(contact, "OnContactEnded");
+  LuaNotifyContact(contact, CONTACT_ENDED);
 }
 
 void LevelLayer::LevelComplete() {
   setTouchEnabled(false);
+  unschedule(schedule_selector(LevelLayer::UpdatePhysics));
   GameManager::sharedManager()->GameOver(true);
 }
 
 void LevelLayer::draw() {
   CCLayerColor::draw();
 
-#ifdef COCOS2D_DEBUG
-  if (debug_enabled_) {
-    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position);
-    kmGLPushMatrix();
+  if (debug_enabled_ && box2d_debug_draw_) {
+    box2d_debug_draw_->Clear();
     box2d_world_->DrawDebugData();
-    kmGLPopMatrix();
+    box2d_debug_draw_->DrawContacts(box2d_world_);
+    box2d_debug_draw_->Flush();
+  }
+
+  if (debug_enabled_) {
+    // Keep the graph fixed to the screen as the camera moves.
+    CCPoint origin = CCDirector::sharedDirector()->getVisibleOrigin();
+    origin = ccpSub(origin, getPosition());
+    CCRect rect(origin.x + 10, origin.y + 10, PROFILE_GRAPH_WIDTH,
+                PROFILE_GRAPH_HEIGHT);
+    physics_profiler_.Draw(rect, PHYSICS_TIMESTEP * 1000);
+  }
+}
+
+void LevelLayer::AddStaticNode(CCNode* node) {
+  assert(node->getParent() == this);
+  UpdateStaticNodeState(node, &static_nodes_[node]);
+  static_cache_dirty_ = true;
+}
+
+void LevelLayer::RemoveStaticNode(CCNode* node) {
+  if (static_nodes_.erase(node))
+    static_cache_dirty_ = true;
+}
+
+bool LevelLayer::IsStaticNode(CCNode* node) {
+  return static_nodes_.find(node) != static_nodes_.end();
+}
+
+bool LevelLayer::GetStaticAppearance(CCNode* node) {
+  if (node->numberOfRunningActions())
+    return false;
+
+  NodeAppearance appearance;
+  appearance.transform = node->nodeToParentTransform();
+  appearance.visible = node->isVisible();
+  appearance.color = ccc3(255, 255, 255);
+  appearance.opacity = 255;
+  CCRGBAProtocol* rgba = dynamic_cast<CCRGBAProtocol*>(node);
+  if (rgba) {
+    appearance.color = rgba->getColor();
+    appearance.opacity = rgba->getOpacity();
+  }
+  static_appearance_.push_back(appearance);
+
+  CCArray* children = node->getChildren();
+  if (!children)
+    return true;
+  for (unsigned int i = 0; i < children->count(); i++) {
+    CCNode* child = static_cast<CCNode*>(children->objectAtIndex(i));
+    if (!GetStaticAppearance(child))
+      return false;
+  }
+  return true;
+}
+
+bool LevelLayer::UpdateStaticNodeState(CCNode* node,
+                                       StaticNodeState* state) {
+  bool changed = false;
+  StrokeBatch* batch = dynamic_cast<StrokeBatch*>(node);
+  if (batch && batch->GetVersion() != state->batch_version) {
+    state->batch_version = batch->GetVersion();
+    changed = true;
+  }
+
+  static_appearance_.clear();
+  if (!GetStaticAppearance(node)) {
+    // Actions can change anything so animated nodes are redrawn every
+    // frame, and once more after the action ends.
+    state->appearance.clear();
+    return true;
+  }
+
+  const std::vector<NodeAppearance>& old = state->appearance;
+  if (old.size() != static_appearance_.size())
+    changed = true;
+  for (size_t i = 0; !changed && i < old.size(); i++) {
+    const NodeAppearance& a = old[i];
+    const NodeAppearance& b = static_appearance_[i];
+    changed = a.visible != b.visible || a.opacity != b.opacity ||
+              a.color.r != b.color.r || a.color.g != b.color.g ||
+              a.color.b != b.color.b ||
+              !CCAffineTransformEqualToTransform(a.transform, b.transform);
+  }
+  if (changed)
+    state->appearance.swap(static_appearance_);
+  return changed;
+}
+
+void LevelLayer::UpdateStaticCache() {
+  StaticNodeMap::iterator it;
+  for (it = static_nodes_.begin(); it != static_nodes_.end(); ++it) {
+    if (UpdateStaticNodeState(it->first, &it->second))
+      static_cache_dirty_ = true;
+  }
+
+  CCRect view = GetViewRect();
+  if (!static_cache_) {
+    CCSize size = view.size;
+    if (IsScrollable())
+      size = CCSizeMake(size.width * STATIC_CACHE_SCALE,
+                        size.height * STATIC_CACHE_SCALE);
+    static_cache_ = CCRenderTexture::create(size.width, size.height);
+    static_cache_->retain();
+    static_cache_rect_.size = size;
+    static_cache_dirty_ = true;
+  }
+
+  // Recenter the cached area on the view once the view leaves it.
+  CCRect& rect = static_cache_rect_;
+  if (static_cache_dirty_ ||
+      view.getMinX() < rect.getMinX() || view.getMaxX() > rect.getMaxX() ||
+      view.getMinY() < rect.getMinY() || view.getMaxY() > rect.getMaxY()) {
+    rect.origin = ccp(view.getMidX() - rect.size.width / 2,
+                      view.getMidY() - rect.size.height / 2);
+    if (!IsScrollable())
+      rect.origin = view.origin;
+    static_cache_->setPosition(ccp(rect.getMidX(), rect.getMidY()));
+    static_cache_dirty_ = true;
+  }
+
+  if (!static_cache_dirty_)
+    return;
+
+  // The render texture draws in the layer's coordinate space, so the
+  // static nodes are drawn as children of the layer would be, offset
+  // so the cached area starts at the texture's origin.
+  static_cache_->beginWithClear(0, 0, 0, 0);
+  kmGLPushMatrix();
+  kmGLTranslatef(-rect.origin.x, -rect.origin.y, 0);
+  CCArray* children = getChildren();
+  for (unsigned int i = 0; i < children->count(); i++) {
+    CCNode* child = static_cast<CCNode*>(children->objectAtIndex(i));
+    if (IsStaticNode(child))
+      child->visit();
+  }
+  kmGLPopMatrix();
+  static_cache_->end();
+  static_cache_dirty_ = false;
+}
+
+void LevelLayer::SetLevelBounds(float x, float y, float width,
+                                float height) {
+  level_bounds_ = CCRect(x, y, width, height);
+  reset_culling_ = true;
+  // The cache size depends on whether the level scrolls.
+  CC_SAFE_RELEASE_NULL(static_cache_);
+  UpdateCamera();
+}
+
+void LevelLayer::SetCameraTarget(CCNode* node) {
+  assert(!node || node->getParent() == this);
+  camera_target_ = node;
+  UpdateCamera();
+}
+
+CCRect LevelLayer::GetViewRect() {
+  CCSize size = CCDirector::sharedDirector()->getVisibleSize();
+  CCPoint position = getPosition();
+  return CCRect(-position.x, -position.y, size.width, size.height);
+}
+
+bool LevelLayer::IsScrollable() {
+  CCSize size = CCDirector::sharedDirector()->getVisibleSize();
+  return level_bounds_.size.width > size.width ||
+         level_bounds_.size.height > size.height;
+}
+
+// Position of the left (or bottom) edge of a view of size 'view'
+// centered on 'center' without leaving [min, max].
+static float ClampView(float center, float view, float min, float max) {
+  if (max - min <= view)
+    return min;
+  return clampf(center - view / 2, min, max - view);
+}
+
+void LevelLayer::UpdateCamera() {
+  if (!camera_target_)
+    return;
+  CCSize size = CCDirector::sharedDirector()->getVisibleSize();
+  CCPoint center = camera_target_->getPosition();
+  float x = ClampView(center.x, size.width, level_bounds_.getMinX(),
+                      level_bounds_.getMaxX());
+  float y = ClampView(center.y, size.height, level_bounds_.getMinY(),
+                      level_bounds_.getMaxY());
+  setPosition(ccp(-x, -y));
+}
+
+void LevelLayer::UpdateCulling() {
+  // Debug mode hides all children itself.
+  if (headless_ || debug_enabled_ || !IsScrollable())
+    return;
+
+  if (reset_culling_) {
+    PhysicsNodeMap::iterator it;
+    for (it = physics_nodes_.begin(); it != physics_nodes_.end(); ++it)
+      nodes_in_view_.insert(it->second);
+    reset_culling_ = false;
+  }
+
+  // The broadphase finds the bodies near the view without visiting
+  // the rest of the level.
+  CCRect view = GetViewRect();
+  b2AABB aabb;
+  aabb.lowerBound.Set((view.getMinX() - CULL_MARGIN) / PTM_RATIO,
+                      (view.getMinY() - CULL_MARGIN) / PTM_RATIO);
+  aabb.upperBound.Set((view.getMaxX() + CULL_MARGIN) / PTM_RATIO,
+                      (view.getMaxY() + CULL_MARGIN) / PTM_RATIO);
+  BodyQueryCallback callback(BodyQueryCallback::QUERY_AABB, 0xFFFF);
+  callback.SetAABB(aabb);
+  box2d_world_->QueryAABB(&callback, aabb);
+
+  std::set<PhysicsNode*> in_view;
+  const std::vector<b2Body*>& bodies = callback.bodies();
+  for (size_t i = 0; i < bodies.size(); i++) {
+    PhysicsNode* node = GetPhysicsNode(bodies[i]);
+    // Static nodes are drawn by the static cache.
+    if (node && !IsStaticNode(node))
+      in_view.insert(node);
+  }
+
+  std::set<PhysicsNode*>::iterator it;
+  for (it = nodes_in_view_.begin(); it != nodes_in_view_.end(); ++it) {
+    if (!in_view.count(*it) && !IsStaticNode(*it))
+      (*it)->setVisible(false);
+  }
+  for (it = in_view.begin(); it != in_view.end(); ++it) {
+    if (!nodes_in_view_.count(*it))
+      (*it)->setVisible(true);
+  }
+  nodes_in_view_.swap(in_view);
+}
+
+void LevelLayer::visit() {
+  // The debug view hides all children so the cache isn't needed.
+  if (static_nodes_.empty() || headless_ || debug_enabled_) {
+    CCLayerColor::visit();
+    return;
+  }
+  if (!isVisible())
+    return;
+
+  sortAllChildren();
+  UpdateStaticCache();
+
+  // Same as CCNode::visit except that static children are replaced by
+  // the cache, which is drawn straight after the layer itself.
+  kmGLPushMatrix();
+  transform();
+  CCArray* children = getChildren();
+  unsigned int count = children->count();
+  unsigned int i = 0;
+  for (; i < count; i++) {
+    CCNode* child = static_cast<CCNode*>(children->objectAtIndex(i));
+    if (child->getZOrder() >= 0)
+      break;
+    if (!IsStaticNode(child))
+      child->visit();
+  }
+  draw();
+  static_cache_->visit();
+  for (; i < count; i++) {
+    CCNode* child = static_cast<CCNode*>(children->objectAtIndex(i));
+    if (!IsStaticNode(child))
+      child->visit();
+  }
+  m_uOrderOfArrival = 0;
+  kmGLPopMatrix();
+}
+
+void LevelLayer::onExit() {
+  // Don't leave the director throttled once the level has gone.
+  Wake();
+  CCLayerColor::onExit();
+}
+
+bool LevelLayer::ccTouchBegan(CCTouch* touch, CCEvent* event) {
+  Wake();
+  return CCLayerColor::ccTouchBegan(touch, event);
+}
+
+void LevelLayer::ccTouchMoved(CCTouch* touch, CCEvent* event) {
+  Wake();
+  CCLayerColor::ccTouchMoved(touch, event);
+}
+
+void LevelLayer::ccTouchesBegan(CCSet* touches, CCEvent* event) {
+  Wake();
+  CCLayerColor::ccTouchesBegan(touches, event);
+}
+
+void LevelLayer::ccTouchesMoved(CCSet* touches, CCEvent* event) {
+  Wake();
+  CCLayerColor::ccTouchesMoved(touches, event);
+}
+
+bool LevelLayer::DumpPhysicsProfile(const char* filename) {
+  return physics_profiler_.DumpCSV(filename);
+}
+
+void LevelLayer::PushBodies(const std::vector<b2Body*>& bodies) {
+  lua_State* state = lua_stack_->getLuaState();
+  lua_createtable(state, bodies.size(), 0);
+  for (size_t i = 0; i < bodies.size(); i++) {
+    tolua_pushusertype(state, bodies[i], "b2Body");
+    lua_rawseti(state, -2, i + 1);
   }
-#endif
 }
 
-void LevelLayer::FindBodiesAt(b2Vec2* pos, int lua_handler) {
+void LevelLayer::QueryPoint(b2Vec2* point, int lua_handler, uint16 mask) {
   b2AABB aabb;
-  b2Vec2 d;
-  d.Set(0.001f, 0.001f);
-  aabb.lowerBound = *pos - d;
-  aabb.upperBound = *pos + d;
-
-  // Query the world for overlapping shapes.
-  Box2DCallbackHandler handler(pos, lua_stack_, lua_handler);
-  box2d_world_->QueryAABB(&handler, aabb);
+  b2Vec2 d(0.001f, 0.001f);
+  aabb.lowerBound = *point - d;
+  aabb.upperBound = *point + d;
+
+  BodyQueryCallback query(BodyQueryCallback::QUERY_POINT, mask);
+  query.SetPoint(*point);
+  box2d_world_->QueryAABB(&query, aabb);
+
+  PushBodies(query.bodies());
+  lua_stack_->executeFunctionByHandler(lua_handler, 1);
+  lua_stack_->removeScriptHandler(lua_handler);
+}
+
+void LevelLayer::QueryAABB(b2Vec2* lower, b2Vec2* upper, int lua_handler,
+                           uint16 mask) {
+  b2AABB aabb;
+  aabb.lowerBound = *lower;
+  aabb.upperBound = *upper;
+
+  BodyQueryCallback query(BodyQueryCallback::QUERY_AABB, mask);
+  query.SetAABB(aabb);
+  box2d_world_->QueryAABB(&query, aabb);
+
+  PushBodies(query.bodies());
+  lua_stack_->executeFunctionByHandler(lua_handler, 1);
+  lua_stack_->removeScriptHandler(lua_handler);
+}
+
+void LevelLayer::QueryRadius(b2Vec2* center, float radius, int lua_handler,
+                             uint16 mask) {
+  b2AABB aabb;
+  b2Vec2 d(radius, radius);
+  aabb.lowerBound = *center - d;
+  aabb.upperBound = *center + d;
+
+  BodyQueryCallback query(BodyQueryCallback::QUERY_RADIUS, mask);
+  query.SetCircle(*center, radius);
+  box2d_world_->QueryAABB(&query, aabb);
+
+  PushBodies(query.bodies());
+  lua_stack_->executeFunctionByHandler(lua_handler, 1);
+  lua_stack_->removeScriptHandler(lua_handler);
+}
+
+void LevelLayer::RayCast(b2Vec2* from, b2Vec2* to, int lua_handler,
+                         uint16 mask) {
+  BodyRayCastCallback ray_cast(mask);
+  // box2d asserts on zero length rays.
+  if ((*to - *from).LengthSquared() > 0.0f)
+    box2d_world_->RayCast(&ray_cast, *from, *to);
+
+  std::vector<b2Body*> bodies;
+  std::vector<float> fractions;
+  ray_cast.GetHits(&bodies, &fractions);
+
+  PushBodies(bodies);
+  lua_State* state = lua_stack_->getLuaState();
+  lua_createtable(state, fractions.size(), 0);
+  for (size_t i = 0; i < fractions.size(); i++) {
+    lua_pushnumber(state, fractions[i]);
+    lua_rawseti(state, -2, i + 1);
+  }
+  lua_stack_->executeFunctionByHandler(lua_handler, 2);
+  lua_stack_->removeScriptHandler(lua_handler);
 }
@@ -4,19 +4,21 @@
 #ifndef LEVEL_LAYER_H_
 #define LEVEL_LAYER_H_
 
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "cocos2d.h"
 #include "CCLuaStack.h"
 #include "Box2D/Box2D.h"
-
-#ifdef COCOS2D_DEBUG
-#ifndef WIN32
-#include "GLES-Render.h"
-#endif
-#endif
+#include "debug_draw.h"
+#include "geometry.h"
+#include "physics_profiler.h"
 
 USING_NS_CC;
 
-typedef std::vector<cocos2d::CCPoint> PointList;
+class PhysicsNode;
 
 /**
  * Lavel layer in which gameplay takes place.  This layer contains
@@ -30,22 +32,137 @@ class LevelLayer : public CCLayerColor,
 
   CREATE_FUNC(LevelLayer);
 
+  // Create a layer that runs the physics simulation only.  No GL
+  // resources are created so this can be used without a window.
+  static LevelLayer* createHeadless();
+
   virtual bool init();
   virtual void draw();
+  virtual void visit();
+  virtual void onExit();
+
+  // Touches wake the layer up if it is idle (see SetIdleThrottling).
+  virtual bool ccTouchBegan(CCTouch* touch, CCEvent* event);
+  virtual void ccTouchMoved(CCTouch* touch, CCEvent* event);
+  virtual void ccTouchesBegan(CCSet* touches, CCEvent* event);
+  virtual void ccTouchesMoved(CCSet* touches, CCEvent* event);
+
+  using CCLayerColor::addChild;
+  virtual void addChild(CCNode* child, int z_order, int tag);
+  virtual void removeChild(CCNode* child, bool cleanup);
+  virtual void removeAllChildrenWithCleanup(bool cleanup);
 
   b2World* GetWorld() { return box2d_world_; }
 
-  // Find all bodies at a given position and call the
-  // given lua_handler for each one.
-  void FindBodiesAt(b2Vec2* pos, int lua_handler);
+  // Advance the physics simulation by 'dt' seconds of wall time.  The
+  // world is stepped zero or more times using a fixed timestep and the
+  // remainder is used to interpolate the physics nodes.
+  void UpdatePhysics(float dt);
+
+  // Enable or disable stepping of the physics world (the editor
+  // only runs physics on demand).
+  void SetPhysicsEnabled(bool enabled);
+  bool IsPhysicsEnabled() { return physics_enabled_; }
+
+  // Total number of fixed timesteps taken since the level started.
+  int GetPhysicsSubsteps() { return physics_substeps_; }
+
+  // Total simulation time (in seconds) that was discarded because a
+  // frame needed more than the maximum number of substeps.  A growing
+  // value means the device cannot keep up with the simulation.
+  float GetDroppedPhysicsTime() { return dropped_physics_time_; }
+
+  // When enabled (the default) the director's frame rate is lowered
+  // once every body in the world is asleep and no node anywhere in the
+  // scene is running an action.  This is checked about once a second.
+  // The world isn't stepped while throttled.  Full speed resumes on
+  // touch input, when a body wakes up or an action starts, or on a
+  // call to Wake.
+  void SetIdleThrottling(bool enabled);
+  bool IsThrottled() { return throttled_; }
+  void Wake();
+
+  // Total time (in seconds) spent throttled since the level started.
+  float GetThrottledTime() { return throttled_time_; }
+
+  // Static nodes are children of the layer that are drawn once into a
+  // render texture which is then drawn in their place every frame.
+  // The texture is redrawn when a static node is added, removed, moved
+  // or hidden, when it or one of its descendants runs an action or
+  // changes its transform, visibility, color or opacity, and when the
+  // strokes of a static StrokeBatch change.  Other changes inside a
+  // static node (such as adding children to it) need a call to
+  // InvalidateStaticCache.  Static nodes are drawn behind all other
+  // children with a non-negative z order.
+  void AddStaticNode(CCNode* node);
+  void RemoveStaticNode(CCNode* node);
+  void InvalidateStaticCache() { static_cache_dirty_ = true; }
+
+  // Set the area (in points) that the level covers.  It defaults to
+  // the size of the screen.  When the level is larger than the screen
+  // the camera can scroll around it, and physics nodes outside the
+  // view are hidden so drawing costs don't grow with the level size.
+  void SetLevelBounds(float x, float y, float width, float height);
+
+  // Scroll the layer to keep 'node' (a child of the layer, usually
+  // the physics node of a body) in the center of the view, without
+  // showing anything outside the level bounds.  Pass NULL to stop.
+  void SetCameraTarget(CCNode* node);
 
+  // The part of the level currently on screen, in layer coordinates.
+  CCRect GetViewRect();
+
+  // Spatial queries.  Each of these finds the bodies that have a
+  // fixture whose category bits match 'mask' and calls 'lua_handler'
+  // once with a Lua array of those bodies.  Each body is reported only
+  // once no matter how many of its fixtures match.  The handler is
+  // released after it is called.
+
+  // Bodies with a fixture containing 'point'.
+  void QueryPoint(b2Vec2* point, int lua_handler, uint16 mask);
+
+  // Bodies with a fixture overlapping the box from 'lower' to 'upper'.
+  void QueryAABB(b2Vec2* lower, b2Vec2* upper, int lua_handler,
+                 uint16 mask);
+
+  // Bodies with a fixture within 'radius' of 'center'.
+  void QueryRadius(b2Vec2* center, float radius, int lua_handler,
+                   uint16 mask);
+
+  // Bodies with a fixture crossing the line from 'from' to 'to'.  The
+  // bodies are ordered by distance from 'from' and the handler gets a
+  // second array with the fraction along the line of each body's
+  // nearest hit.
+  void RayCast(b2Vec2* from, b2Vec2* to, int lua_handler, uint16 mask);
+
+  // Toggle drawing of the box2d debug data and the physics profile
+  // graph.
   void ToggleDebug();
+
+  // Choose what the box2d debug data shows.  'flags' is a combination
+  // of the b2Draw bits and DebugDraw::e_contactBit.
+  void SetDebugDrawFlags(uint32 flags);
+  uint32 GetDebugDrawFlags();
+
+  // Write the profile of the most recent physics steps to 'filename'
+  // as CSV.
+  bool DumpPhysicsProfile(const char* filename);
+  PhysicsProfiler* GetPhysicsProfiler() { return &physics_profiler_; }
   bool LoadLevel(int level_number);
 
-  // Called by box2d when contacts start
+  // Only report contacts between bodies with the given tags to Lua.
+  // A tag of zero matches any tagged body, so AddContactFilter(tag, 0)
+  // subscribes to all contacts involving 'tag'.  Until the first filter
+  // is added all contacts between tagged bodies are reported.
+  void AddContactFilter(int tag1, int tag2);
+  void ClearContactFilters();
+  bool HasContactFilters() { return !contact_filters_.empty(); }
+
+  // Called by box2d when contacts start.  The contact is recorded
+  // and reported to Lua after the step (see DeliverContacts).
   void BeginContact(b2Contact* contact);
 
-  // Called by box2d when contacts finish
+  // Called by box2d when contacts finish.
   void EndContact(b2Contact* contact);
 
   // Methods that are exposed to / called by lua the lua
@@ -53,28 +170,181 @@ class LevelLayer : public CCLayerColor,
   void LevelComplete();
 
  protected:
-  // Called by BeginContact and EndContact to nofify Lua code when box2d
-  // contacts start and finish.
-  void LuaNotifyContact(b2Contact* contact, const char* function_name);
+  // Kinds of contact event reported to Lua.  These values must match
+  // the ones in loader.lua.
+  enum ContactKind {
+    CONTACT_BEGAN = 1,
+    CONTACT_ENDED = 2
+  };
+
+  // Called by BeginContact and EndContact to record contacts between
+  // tagged bodies.  Lua must not be called from here since box2d is
+  // in the middle of a step and the world is locked.  Bodies made of
+  // many fixtures touch each other via many contacts so these are
+  // counted per body pair and only the first began and last ended
+  // contact is recorded.
+  void LuaNotifyContact(b2Contact* contact, ContactKind kind);
+
+  // Pass all contacts recorded since the last call to the Lua
+  // OnContacts function as a single flat array of (tag1, tag2, kind)
+  // triples.
+  void DeliverContacts();
+
+  // Returns true if a contact between the two tags should be reported.
+  bool IsContactWanted(int tag1, int tag2);
 
   bool LoadLua(int level_number);
 
   bool InitPhysics();
 
+  // Store the current state of the physics nodes with moving bodies so
+  // that it can be interpolated against the state after the next step.
+  void SavePhysicsState();
+
+  // Set the interpolation factor on the physics nodes whose bodies are
+  // awake and not static.  Nodes whose bodies fell asleep since the
+  // last call are moved to their final position.  The cost of this
+  // scales with the number of moving bodies rather than all bodies.
+  void SyncPhysicsNodes(float alpha);
+
+  // Set the interpolation factor on all physics nodes.
+  void InterpolatePhysicsNodes(float alpha);
+
+  // Return the node for a body, or NULL if it has none.
+  PhysicsNode* GetPhysicsNode(b2Body* body);
+
+  // Push a Lua array of the given bodies onto the Lua stack.
+  void PushBodies(const std::vector<b2Body*>& bodies);
+
+  // Returns true if no body is awake and no action is running.  This
+  // visits every body so it isn't called every frame.
+  bool IsIdle();
+
+  // Track how long the layer has been idle and start or stop
+  // throttling accordingly.  Returns true if the layer is throttled.
+  bool UpdateIdleState(float dt);
+
+  bool IsStaticNode(CCNode* node);
+
+  // Record the appearance of 'node' and its descendants in
+  // static_appearance_.  Returns false if any of them has a running
+  // action, in which case it must be redrawn every frame.
+  bool GetStaticAppearance(CCNode* node);
+
+  // Returns true if the cache must be redrawn for 'node', updating
+  // its recorded state.
+  bool UpdateStaticNodeState(CCNode* node, StaticNodeState* state);
+
+  // Redraw the static node cache if any static node has changed.
+  void UpdateStaticCache();
+
+  // Returns true if the level is larger than the view.
+  bool IsScrollable();
+
+  // Move the layer so the camera target is in view.
+  void UpdateCamera();
+
+  // Show the physics nodes whose bodies overlap the view and hide the
+  // ones that have left it.
+  void UpdateCulling();
+
  private:
   // Box2D physics world
   b2World* box2d_world_;
 
-#ifdef COCOS2D_DEBUG
-#ifndef WIN32
-  // Debug drawing support for Box2D.
-  GLESDebugDraw* box2d_debug_draw_;
-#endif
-#endif
+  // Debug drawing support for Box2D (NULL when headless).
+  DebugDraw* box2d_debug_draw_;
 
   // Flag to enable drawing of Box2D debug data.
   bool debug_enabled_;
 
+  // True when running without a GL context (see createHeadless).
+  bool headless_;
+
+  // Fixed timestep state.
+  bool physics_enabled_;
+  float physics_accumulator_;
+  int physics_substeps_;
+  float dropped_physics_time_;
+
+  // Idle throttling state.
+  bool idle_throttling_;
+  bool throttled_;
+  // Set when throttling ends so the long throttled frame isn't fed to
+  // the physics accumulator.
+  bool resuming_;
+  float idle_time_;
+  float throttled_time_;
+  // Director animation interval to restore when throttling ends.
+  double normal_animation_interval_;
+
+  // How a node in a static node's subtree looked when the cache was
+  // last drawn.
+  struct NodeAppearance {
+    CCAffineTransform transform;
+    bool visible;
+    ccColor3B color;
+    GLubyte opacity;
+  };
+  // State of a static node when the cache was last drawn: the
+  // appearance of the node and its descendants in visiting order, and
+  // the version of its strokes if it is a StrokeBatch.
+  struct StaticNodeState {
+    StaticNodeState() : batch_version(0) {}
+    std::vector<NodeAppearance> appearance;
+    unsigned int batch_version;
+  };
+  typedef std::map<CCNode*, StaticNodeState> StaticNodeMap;
+  StaticNodeMap static_nodes_;
+  // Scratch space for the appearance of the static node being checked.
+  std::vector<NodeAppearance> static_appearance_;
+  CCRenderTexture* static_cache_;
+  bool static_cache_dirty_;
+  // Area of the layer drawn into static_cache_.  For scrollable levels
+  // this is larger than the view so the cache is only redrawn once the
+  // view leaves it.
+  CCRect static_cache_rect_;
+
+  // Camera state.
+  CCRect level_bounds_;
+  CCNode* camera_target_;
+
+  // Physics nodes left visible by the last UpdateCulling.  When
+  // reset_culling_ is set all nodes are hidden before the next update.
+  std::set<PhysicsNode*> nodes_in_view_;
+  bool reset_culling_;
+
+  // Profile of the most recent physics steps.
+  PhysicsProfiler physics_profiler_;
+
+  // Physics nodes which are children of this layer, keyed by body.
+  typedef std::map<b2Body*, PhysicsNode*> PhysicsNodeMap;
+  PhysicsNodeMap physics_nodes_;
+
+  // Nodes updated by the last SyncPhysicsNodes, and scratch space for
+  // building the next list without reallocating.
+  std::vector<PhysicsNode*> moving_nodes_;
+  std::vector<PhysicsNode*> next_moving_nodes_;
+
+  // Tag pairs registered with AddContactFilter.  The larger tag is
+  // stored first so that a wildcard (zero) always comes second.
+  typedef std::pair<int, int> TagPair;
+  std::set<TagPair> contact_filters_;
+
+  // Number of touching fixture contacts between each pair of tagged
+  // bodies, and whether the start of the contact was reported to Lua.
+  // The lower address is stored first.
+  typedef std::pair<b2Body*, b2Body*> BodyPair;
+  struct BodyContact {
+    BodyContact() : count(0), reported(false) {}
+    int count;
+    bool reported;
+  };
+  std::map<BodyPair, BodyContact> body_contacts_;
+
+  // Contacts waiting to be delivered to Lua, three ints per contact.
+  std::vector<int> pending_contacts_;
+
   CCLuaStack* lua_stack_;
 };
 
@@ -0,0 +1,256 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "physics_node.h"
+
+// Segments of a stroke that turn by more than this many radians get
+// a circle fixture at the corner to fill the gap between their boxes.
+#define STROKE_CORNER_ANGLE 0.2f
+
+// A stroke that ends within this many thicknesses of its start is
+// treated as a closed shape and filled in.
+#define STROKE_CLOSE_DISTANCE 3.0f
+
+PhysicsNode::PhysicsNode() :
+    previous_position_(0.0f, 0.0f),
+    previous_angle_(0.0f),
+    drawn_position_(0.0f, 0.0f),
+    drawn_angle_(0.0f),
+    alpha_(1.0f),
+    transform_dirty_(true),
+    batching_fixtures_(false) {
+}
+
+void PhysicsNode::setB2Body(b2Body* body) {
+  CCPhysicsNode::setB2Body(body);
+  SavePhysicsState();
+  transform_dirty_ = true;
+}
+
+void PhysicsNode::setPosition(const CCPoint& position) {
+  CCPhysicsNode::setPosition(position);
+  // The body was moved by hand (e.g. by the editor) so there is
+  // nothing to interpolate from.
+  SavePhysicsState();
+  Interpolate(1.0f);
+}
+
+void PhysicsNode::setRotation(float rotation) {
+  CCPhysicsNode::setRotation(rotation);
+  SavePhysicsState();
+  Interpolate(1.0f);
+}
+
+void PhysicsNode::Interpolate(float alpha) {
+  alpha_ = alpha;
+  transform_dirty_ = true;
+}
+
+void PhysicsNode::SavePhysicsState() {
+  b2Body* body = getB2Body();
+  if (!body)
+    return;
+  previous_position_ = body->GetPosition();
+  previous_angle_ = body->GetAngle();
+}
+
+CCAffineTransform PhysicsNode::nodeToParentTransform() {
+  b2Body* body = getB2Body();
+  if (!body)
+    return CCPhysicsNode::nodeToParentTransform();
+
+  b2Vec2 pos = body->GetPosition();
+  float angle = body->GetAngle();
+  if (!transform_dirty_) {
+    if (pos == drawn_position_ && angle == drawn_angle_)
+      return m_sTransform;
+    // The body was moved without the LevelLayer knowing, so there is
+    // nothing to interpolate from.
+    SavePhysicsState();
+    alpha_ = 1.0f;
+  }
+  drawn_position_ = pos;
+  drawn_angle_ = angle;
+
+  if (alpha_ < 1.0f) {
+    float beta = 1.0f - alpha_;
+    pos = alpha_ * pos + beta * previous_position_;
+    angle = alpha_ * angle + beta * previous_angle_;
+  }
+
+  float ptm_ratio = getPTMRatio();
+  float x = pos.x * ptm_ratio;
+  float y = pos.y * ptm_ratio;
+
+  if (m_bIgnoreAnchorPointForPosition) {
+    x += m_obAnchorPointInPoints.x;
+    y += m_obAnchorPointInPoints.y;
+  }
+
+  // Make matrix
+  float c = cosf(angle);
+  float s = sinf(angle);
+
+  if (!m_obAnchorPointInPoints.equals(CCPointZero)) {
+    x += c * -m_obAnchorPointInPoints.x + -s * -m_obAnchorPointInPoints.y;
+    y += s * -m_obAnchorPointInPoints.x + c * -m_obAnchorPointInPoints.y;
+  }
+
+  m_sTransform = CCAffineTransformMake(c, s, -s, c, x, y);
+  transform_dirty_ = false;
+  m_bInverseDirty = true;
+  return m_sTransform;
+}
+
+void PhysicsNode::BeginFixtures() {
+  assert(!batching_fixtures_);
+  batching_fixtures_ = true;
+}
+
+b2Fixture* PhysicsNode::AddFixture(b2FixtureDef* fixture_def) {
+  b2Body* body = getB2Body();
+  assert(body);
+  if (!batching_fixtures_)
+    return body->CreateFixture(fixture_def);
+
+  b2FixtureDef def = *fixture_def;
+  def.density = 0;
+  b2Fixture* fixture = body->CreateFixture(&def);
+  deferred_densities_.push_back(std::make_pair(fixture,
+                                               fixture_def->density));
+  return fixture;
+}
+
+void PhysicsNode::EndFixtures() {
+  assert(batching_fixtures_);
+  batching_fixtures_ = false;
+  if (deferred_densities_.empty())
+    return;
+
+  for (size_t i = 0; i < deferred_densities_.size(); i++)
+    deferred_densities_[i].first->SetDensity(deferred_densities_[i].second);
+  deferred_densities_.clear();
+  getB2Body()->ResetMassData();
+}
+
+void PhysicsNode::MakeDynamic(uint16 category) {
+  b2Body* body = getB2Body();
+  assert(body);
+  for (b2Fixture* f = body->GetFixtureList(); f; f = f->GetNext()) {
+    b2Filter filter = f->GetFilterData();
+    filter.categoryBits = category;
+    filter.maskBits = category;
+    f->SetFilterData(filter);
+  }
+  // This computes the mass once for all fixtures.
+  body->SetType(b2_dynamicBody);
+}
+
+void PhysicsNode::AddStrokePoint(const CCPoint& point) {
+  stroke_points_.push_back(convertToNodeSpace(point));
+}
+
+int PhysicsNode::FinishStroke(b2FixtureDef* fixture_def, float thickness,
+                              float tolerance) {
+  assert(getB2Body());
+
+  PointList points;
+  SimplifyPolyline(stroke_points_, tolerance, &points);
+  stroke_points_.clear();
+
+  bool own_batch = !batching_fixtures_;
+  if (own_batch)
+    BeginFixtures();
+  int count = AddStrokeFixtures(&points, fixture_def, thickness);
+  if (own_batch)
+    EndFixtures();
+  return count;
+}
+
+int PhysicsNode::AddStrokeFixtures(PointList* stroke,
+                                   b2FixtureDef* fixture_def,
+                                   float thickness) {
+  PointList& points = *stroke;
+  float ptm_ratio = getPTMRatio();
+  if (IsClosedStroke(points, thickness)) {
+    // The last point is next to the first so the polygon is closed
+    // without it.
+    points.pop_back();
+    int count = AddPolygonFixtures(points, fixture_def);
+    if (count)
+      return count;
+    // Self intersecting loops can't be filled so fall back to
+    // covering the outline.
+    points.push_back(points.front());
+  }
+
+  float radius = thickness / ptm_ratio;
+  float min_corner_cos = cosf(STROKE_CORNER_ANGLE);
+  b2FixtureDef def = *fixture_def;
+  int count = 0;
+
+  b2Vec2 last_direction(0, 0);
+  for (size_t i = 1; i < points.size(); i++) {
+    b2Vec2 start(points[i-1].x / ptm_ratio, points[i-1].y / ptm_ratio);
+    b2Vec2 end(points[i].x / ptm_ratio, points[i].y / ptm_ratio);
+    b2Vec2 direction = end - start;
+    float length = direction.Normalize();
+    if (length < b2_linearSlop)
+      continue;
+
+    if (count && b2Dot(direction, last_direction) < min_corner_cos) {
+      b2CircleShape circle;
+      circle.m_p = start;
+      circle.m_radius = radius;
+      def.shape = &circle;
+      AddFixture(&def);
+      count++;
+    }
+
+    b2PolygonShape box;
+    box.SetAsBox(length / 2, radius, 0.5f * (start + end),
+                 atan2f(direction.y, direction.x));
+    def.shape = &box;
+    AddFixture(&def);
+    count++;
+    last_direction = direction;
+  }
+
+  return count;
+}
+
+bool PhysicsNode::IsClosedStroke(const PointList& points, float thickness) {
+  // At least a triangle plus the closing point.
+  if (points.size() < 4)
+    return false;
+  float distance = ccpDistance(points.front(), points.back());
+  return distance < thickness * STROKE_CLOSE_DISTANCE;
+}
+
+int PhysicsNode::AddPolygonFixtures(const PointList& polygon,
+                                    b2FixtureDef* fixture_def) {
+  float ptm_ratio = getPTMRatio();
+  std::vector<PointList> pieces;
+  if (!DecomposePolygon(polygon, b2_maxPolygonVertices,
+                        b2_linearSlop * ptm_ratio, &pieces))
+    return 0;
+
+  // Box2D asserts on slivers so skip any piece smaller than this.
+  float min_area = b2_linearSlop * b2_linearSlop * ptm_ratio * ptm_ratio;
+  b2FixtureDef def = *fixture_def;
+  b2Vec2 vertices[b2_maxPolygonVertices];
+  int count = 0;
+  for (size_t i = 0; i < pieces.size(); i++) {
+    const PointList& piece = pieces[i];
+    if (PolygonArea(piece) < min_area)
+      continue;
+    for (size_t j = 0; j < piece.size(); j++)
+      vertices[j].Set(piece[j].x / ptm_ratio, piece[j].y / ptm_ratio);
+    b2PolygonShape shape;
+    shape.Set(vertices, piece.size());
+    def.shape = &shape;
+    AddFixture(&def);
+    count++;
+  }
+  return count;
+}
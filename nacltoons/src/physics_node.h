@@ -0,0 +1,108 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef PHYSICS_NODE_H_
+#define PHYSICS_NODE_H_
+
+#include "cocos2d.h"
+#include "physics_nodes/CCPhysicsNode.h"
+#include "Box2D/Box2D.h"
+#include "geometry.h"
+
+USING_NS_CC;
+USING_NS_CC_EXT;
+
+/**
+ * Physics node used for all shapes in a level.  The LevelLayer steps
+ * the box2d world with a fixed timestep, so the body state rarely lines
+ * up with the frame being drawn.  This node renders its body at a
+ * position interpolated between the last two physics steps.
+ *
+ * Unlike CCPhysicsNode the transform is cached and only recomputed
+ * when the node is marked dirty.  The LevelLayer does this only for
+ * nodes whose bodies are awake, so sleeping and static bodies cost
+ * no more than a comparison with the body's position when drawn.  That
+ * comparison catches bodies moved directly (e.g. by a script calling
+ * b2Body::SetTransform), which are drawn at their new position.
+ */
+class PhysicsNode : public CCPhysicsNode {
+ public:
+  PhysicsNode();
+
+  CREATE_FUNC(PhysicsNode);
+
+  void setB2Body(b2Body* body);
+
+  using CCPhysicsNode::setPosition;
+  virtual void setPosition(const CCPoint& position);
+  virtual void setRotation(float rotation);
+  virtual CCAffineTransform nodeToParentTransform();
+
+  // Record the current body transform as the previous physics state.
+  // Called by the LevelLayer before the final step of each frame.
+  void SavePhysicsState();
+
+  // Set how far between the previous and current physics state this
+  // node should be drawn (0.0 = previous, 1.0 = current).  This also
+  // marks the transform as needing to be recomputed.
+  void Interpolate(float alpha);
+
+  // Fixture batching.  Box2D recomputes the mass of a body each time a
+  // fixture with density is added, so building a body from many
+  // fixtures is quadratic.  Fixtures added with AddFixture between
+  // BeginFixtures and EndFixtures are created without density and the
+  // mass is computed once by EndFixtures.  Outside of a batch
+  // AddFixture just creates the fixture.
+  void BeginFixtures();
+  b2Fixture* AddFixture(b2FixtureDef* fixture_def);
+  void EndFixtures();
+
+  // Make the body dynamic and put all of its fixtures in the given
+  // collision category.
+  void MakeDynamic(uint16 category);
+
+  // Record a point of a freehand stroke.  Points are given in world
+  // coordinates and no fixtures are created until FinishStroke.
+  void AddStrokePoint(const CCPoint& point);
+  int GetStrokePointCount() { return stroke_points_.size(); }
+
+  // Simplify the recorded stroke, dropping points within 'tolerance'
+  // pixels of the simplified line, and cover it with fixtures: a box
+  // per remaining segment plus a circle at any corner sharp enough to
+  // leave a gap between boxes.  Strokes that end close to where they
+  // started are instead filled with convex polygons so that the shape
+  // is solid.  'thickness' is half the width of the stroke in pixels
+  // and 'fixture_def' gives the material.  Returns the number of
+  // fixtures created.
+  int FinishStroke(b2FixtureDef* fixture_def, float thickness,
+                   float tolerance);
+
+ private:
+  bool IsClosedStroke(const PointList& points, float thickness);
+
+  // Add the fixtures for a simplified stroke.  The points may be
+  // modified.
+  int AddStrokeFixtures(PointList* points, b2FixtureDef* fixture_def,
+                        float thickness);
+
+  // Fill a simple polygon (in node coordinates) with convex polygon
+  // fixtures.  Returns the number of fixtures created, or zero if the
+  // polygon couldn't be decomposed.
+  int AddPolygonFixtures(const PointList& polygon,
+                         b2FixtureDef* fixture_def);
+
+  b2Vec2 previous_position_;
+  float previous_angle_;
+  // Body position and angle when the cached transform was computed.
+  b2Vec2 drawn_position_;
+  float drawn_angle_;
+  float alpha_;
+  bool transform_dirty_;
+  PointList stroke_points_;
+
+  // Fixtures created during the current batch and their densities.
+  bool batching_fixtures_;
+  std::vector<std::pair<b2Fixture*, float> > deferred_densities_;
+};
+
+#endif  // PHYSICS_NODE_H_
@@ -0,0 +1,99 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "physics_profiler.h"
+
+#include <stdio.h>
+
+PhysicsProfiler::PhysicsProfiler(int capacity) :
+    samples_(capacity),
+    next_(0),
+    count_(0) {
+  assert(capacity > 0);
+}
+
+void PhysicsProfiler::Record(b2World* world) {
+  PhysicsProfileSample& sample = samples_[next_];
+  sample.profile = world->GetProfile();
+  sample.body_count = world->GetBodyCount();
+  sample.contact_count = world->GetContactCount();
+  sample.proxy_count = world->GetProxyCount();
+
+  next_ = (next_ + 1) % samples_.size();
+  if (count_ < (int)samples_.size())
+    count_++;
+}
+
+void PhysicsProfiler::Clear() {
+  next_ = 0;
+  count_ = 0;
+}
+
+const PhysicsProfileSample& PhysicsProfiler::GetSample(int index) {
+  assert(index >= 0 && index < count_);
+  int size = samples_.size();
+  int oldest = (next_ - count_ + size) % size;
+  return samples_[(oldest + index) % size];
+}
+
+void PhysicsProfiler::Draw(const CCRect& rect, float budget_ms) {
+  CCPoint origin = rect.origin;
+  CCPoint top_right = ccp(rect.getMaxX(), rect.getMaxY());
+  ccDrawSolidRect(origin, top_right, ccc4f(0, 0, 0, 0.5f));
+
+  // Scale so that the budget is drawn half way up the graph.
+  float scale = rect.size.height / (2 * budget_ms);
+  float budget_y = origin.y + budget_ms * scale;
+  ccDrawColor4F(1, 0, 0, 1);
+  ccDrawLine(ccp(origin.x, budget_y), ccp(top_right.x, budget_y));
+
+  if (count_ < 2)
+    return;
+
+  // One stacked line per part of the step so that the whole graph
+  // is drawn with a handful of draw calls.
+  std::vector<CCPoint> collide(count_);
+  std::vector<CCPoint> solve(count_);
+  std::vector<CCPoint> step(count_);
+  float dx = rect.size.width / (samples_.size() - 1);
+  for (int i = 0; i < count_; i++) {
+    const b2Profile& profile = GetSample(i).profile;
+    float x = origin.x + i * dx;
+    // Box2D times the broadphase update inside b2World::Solve, so it
+    // is already part of profile.solve.
+    float collide_ms = profile.collide;
+    float solve_ms = collide_ms + profile.solve + profile.solveTOI;
+    collide[i] = ccp(x, origin.y + MIN(collide_ms * scale, rect.size.height));
+    solve[i] = ccp(x, origin.y + MIN(solve_ms * scale, rect.size.height));
+    step[i] = ccp(x, origin.y + MIN(profile.step * scale, rect.size.height));
+  }
+
+  ccDrawColor4F(1, 1, 1, 1);
+  ccDrawPoly(&step[0], count_, false);
+  ccDrawColor4F(1, 1, 0, 1);
+  ccDrawPoly(&solve[0], count_, false);
+  ccDrawColor4F(0, 1, 0, 1);
+  ccDrawPoly(&collide[0], count_, false);
+}
+
+bool PhysicsProfiler::DumpCSV(const char* filename) {
+  FILE* f = fopen(filename, "w");
+  if (!f) {
+    CCLog("error opening profile output: %s", filename);
+    return false;
+  }
+
+  fprintf(f, "step,collide,solve,solve_init,solve_velocity,solve_position,"
+          "broadphase,solve_toi,bodies,contacts,proxies\n");
+  for (int i = 0; i < count_; i++) {
+    const PhysicsProfileSample& sample = GetSample(i);
+    const b2Profile& p = sample.profile;
+    fprintf(f, "%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d\n",
+            p.step, p.collide, p.solve, p.solveInit, p.solveVelocity,
+            p.solvePosition, p.broadphase, p.solveTOI, sample.body_count,
+            sample.contact_count, sample.proxy_count);
+  }
+
+  fclose(f);
+  return true;
+}
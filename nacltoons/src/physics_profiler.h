@@ -0,0 +1,62 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef PHYSICS_PROFILER_H_
+#define PHYSICS_PROFILER_H_
+
+#include <vector>
+
+#include "cocos2d.h"
+#include "Box2D/Box2D.h"
+
+USING_NS_CC;
+
+/**
+ * Timings and object counts for a single step of the box2d world.
+ * Times are in milliseconds.
+ */
+struct PhysicsProfileSample {
+  b2Profile profile;
+  int body_count;
+  int contact_count;
+  // Number of broadphase proxies, i.e. fixtures (or chain edges) of
+  // active bodies.  Unlike counting fixtures this doesn't need to walk
+  // every body on each step.
+  int proxy_count;
+};
+
+/**
+ * Keeps a fixed number of PhysicsProfileSamples in a ring buffer so
+ * that the cost of recent physics steps can be graphed or dumped.
+ */
+class PhysicsProfiler {
+ public:
+  explicit PhysicsProfiler(int capacity);
+
+  // Record the profile of the last step of the given world.
+  void Record(b2World* world);
+
+  void Clear();
+
+  // Number of samples currently held (at most the capacity).
+  int GetSampleCount() { return count_; }
+
+  // Return a sample by age, 0 being the oldest sample held.
+  const PhysicsProfileSample& GetSample(int index);
+
+  // Draw a bar graph of the step times within 'rect', with a line
+  // marking 'budget_ms'.  Collision, solving and the remainder of the
+  // step are drawn in different colors.
+  void Draw(const CCRect& rect, float budget_ms);
+
+  // Write all samples, oldest first, to 'filename' as CSV.
+  bool DumpCSV(const char* filename);
+
+ private:
+  std::vector<PhysicsProfileSample> samples_;
+  // Index at which the next sample will be written.
+  int next_;
+  int count_;
+};
+
+#endif  // PHYSICS_PROFILER_H_
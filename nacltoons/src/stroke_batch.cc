@@ -0,0 +1,160 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "stroke_batch.h"
+
+#include <string.h>
+
+#include "stroke_node.h"
+
+StrokeBatch::StrokeBatch() :
+    texture_(NULL),
+    version_(0) {
+}
+
+StrokeBatch::~StrokeBatch() {
+  for (size_t i = 0; i < entries_.size(); i++)
+    entries_[i].stroke->batch_ = NULL;
+  CC_SAFE_RELEASE(texture_);
+}
+
+StrokeBatch* StrokeBatch::create(CCTexture2D* texture) {
+  StrokeBatch* batch = new StrokeBatch();
+  if (!batch->initWithTexture(texture)) {
+    delete batch;
+    return NULL;
+  }
+  batch->autorelease();
+  return batch;
+}
+
+bool StrokeBatch::initWithTexture(CCTexture2D* texture) {
+  if (!CCNode::init())
+    return false;
+  assert(texture);
+  texture_ = texture;
+  texture_->retain();
+  CCShaderCache* shaders = CCShaderCache::sharedShaderCache();
+  setShaderProgram(shaders->programForKey(kCCShader_PositionTextureColor));
+  return true;
+}
+
+void StrokeBatch::AddStroke(StrokeNode* stroke) {
+  assert(stroke->texture_ == texture_);
+  if (stroke->batch_ == this)
+    return;
+  if (stroke->batch_)
+    stroke->batch_->RemoveStroke(stroke);
+
+  Entry entry;
+  entry.stroke = stroke;
+  entry.offset = vertices_.size();
+  entry.count = 0;
+  entry.transform = CCAffineTransformIdentity;
+  entry.visible = false;
+  entry.dirty = true;
+  stroke->batch_ = this;
+  stroke->batch_index_ = entries_.size();
+  entries_.push_back(entry);
+  version_++;
+}
+
+void StrokeBatch::RemoveStroke(StrokeNode* stroke) {
+  if (stroke->batch_ != this)
+    return;
+  size_t index = stroke->batch_index_;
+  assert(entries_[index].stroke == stroke);
+  ResizeEntry(index, 0);
+  entries_.erase(entries_.begin() + index);
+  for (size_t i = index; i < entries_.size(); i++)
+    entries_[i].stroke->batch_index_ = i;
+  stroke->batch_ = NULL;
+  version_++;
+}
+
+void StrokeBatch::ResizeEntry(size_t index, int count) {
+  Entry& entry = entries_[index];
+  int delta = count - entry.count;
+  if (!delta)
+    return;
+  std::vector<ccV2F_C4B_T2F>::iterator end =
+      vertices_.begin() + entry.offset + entry.count;
+  if (delta > 0) {
+    ccV2F_C4B_T2F zero;
+    memset(&zero, 0, sizeof(zero));
+    vertices_.insert(end, delta, zero);
+  } else {
+    vertices_.erase(end + delta, end);
+  }
+  entry.count = count;
+  entry.dirty = true;
+  for (size_t i = index + 1; i < entries_.size(); i++)
+    entries_[i].offset += delta;
+}
+
+// Returns true if 'node' and all its ancestors are visible.
+static bool IsNodeVisible(CCNode* node) {
+  for (; node; node = node->getParent()) {
+    if (!node->isVisible())
+      return false;
+  }
+  return true;
+}
+
+void StrokeBatch::UpdateEntry(Entry* entry) {
+  StrokeNode* stroke = entry->stroke;
+  // Strokes whose shape has been taken out of the scene are hidden
+  // until they are destroyed or added back.
+  bool visible = stroke->isRunning() && IsNodeVisible(stroke);
+  if (!visible) {
+    if (entry->visible || entry->dirty) {
+      // Zeroed vertices give empty triangles.
+      if (entry->count)
+        memset(&vertices_[entry->offset], 0,
+               entry->count * sizeof(ccV2F_C4B_T2F));
+      entry->visible = false;
+      entry->dirty = false;
+    }
+    return;
+  }
+
+  CCAffineTransform transform = CCAffineTransformConcat(
+      stroke->nodeToWorldTransform(), worldToNodeTransform());
+  bool moved = !entry->visible ||
+      !CCAffineTransformEqualToTransform(transform, entry->transform);
+  if (!moved && !entry->dirty)
+    return;
+
+  // If only the mesh changed then just its changed tail is rewritten.
+  const std::vector<ccV2F_C4B_T2F>& source = stroke->GetVertices();
+  assert(source.size() == (size_t)entry->count);
+  int first = moved ? 0 : MIN(stroke->changed_from_, source.size());
+  stroke->changed_from_ = source.size();
+  for (int i = first; i < entry->count; i++) {
+    ccV2F_C4B_T2F& vertex = vertices_[entry->offset + i];
+    vertex = source[i];
+    CCPoint pos = CCPointApplyAffineTransform(
+        ccp(vertex.vertices.x, vertex.vertices.y), transform);
+    vertex.vertices = vertex2(pos.x, pos.y);
+  }
+  entry->transform = transform;
+  entry->visible = true;
+  entry->dirty = false;
+}
+
+void StrokeBatch::draw() {
+  for (size_t i = 0; i < entries_.size(); i++) {
+    Entry& entry = entries_[i];
+    if (entry.dirty) {
+      int count = entry.stroke->GetVertices().size();
+      if (count != entry.count)
+        ResizeEntry(i, count);
+    }
+    UpdateEntry(&entry);
+  }
+  if (vertices_.empty())
+    return;
+
+  CC_NODE_DRAW_SETUP();
+  StrokeNode::DrawVertices(texture_, &vertices_[0], vertices_.size());
+}
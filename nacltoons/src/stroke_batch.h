@@ -0,0 +1,80 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef STROKE_BATCH_H_
+#define STROKE_BATCH_H_
+
+#include <vector>
+
+#include "cocos2d.h"
+
+USING_NS_CC;
+
+class StrokeNode;
+
+/**
+ * Draws all the StrokeNodes that share a texture with one draw call.
+ * A level has one batch per brush texture.  Strokes stay children of
+ * their shapes, so they move with their physics bodies and are removed
+ * along with them; the batch only borrows their meshes.  Each stroke
+ * owns a range of the batch's vertices which is only rewritten when
+ * the stroke's mesh or its transform relative to the batch changes.
+ * When only the mesh changed just the vertices from the first one
+ * that changed are rewritten, so extending a stroke is cheap.
+ */
+class StrokeBatch : public CCNode {
+ public:
+  StrokeBatch();
+  ~StrokeBatch();
+
+  static StrokeBatch* create(CCTexture2D* texture);
+  bool initWithTexture(CCTexture2D* texture);
+
+  CCTexture2D* getTexture() { return texture_; }
+
+  // Draw 'stroke' as part of this batch.  The stroke must use the
+  // batch's texture.  Strokes remove themselves when destroyed.
+  void AddStroke(StrokeNode* stroke);
+  void RemoveStroke(StrokeNode* stroke);
+  int GetStrokeCount() { return entries_.size(); }
+
+  // Called when the mesh of the stroke at 'index' changes.
+  void SetStrokeDirty(int index) {
+    entries_[index].dirty = true;
+    version_++;
+  }
+
+  // A number that changes whenever a stroke is added to or removed
+  // from the batch or has its mesh changed.  Used by the LevelLayer to
+  // tell when a batch drawn into its static cache needs redrawing.
+  unsigned int GetVersion() { return version_; }
+
+  virtual void draw();
+
+ private:
+  struct Entry {
+    StrokeNode* stroke;
+    // First vertex and number of vertices owned by the stroke.
+    int offset;
+    int count;
+    // Transform the vertices were last written with.
+    CCAffineTransform transform;
+    bool visible;
+    bool dirty;
+  };
+
+  // Change the number of vertices owned by the stroke at 'index'.  The
+  // vertices of later strokes are moved along with their offsets, so
+  // they don't need rewriting.
+  void ResizeEntry(size_t index, int count);
+
+  // Write a stroke's vertices into its range if they are out of date.
+  void UpdateEntry(Entry* entry);
+
+  CCTexture2D* texture_;
+  unsigned int version_;
+  std::vector<Entry> entries_;
+  std::vector<ccV2F_C4B_T2F> vertices_;
+};
+
+#endif  // STROKE_BATCH_H_
@@ -0,0 +1,294 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "stroke_node.h"
+
+#include <stddef.h>
+
+#include "stroke_batch.h"
+
+// Limit on how far a joint between two segments is pushed out so that
+// sharp turns don't produce long spikes.
+#define MAX_MITER_SCALE 2.0f
+
+// Number of vertices in the two triangles of a quad.
+#define QUAD_VERTICES 6
+
+StrokeNode::StrokeNode() :
+    texture_(NULL),
+    thickness_(0),
+    mesh_dirty_(false),
+    built_polylines_(0),
+    changed_from_(0),
+    batch_(NULL),
+    batch_index_(0) {
+}
+
+StrokeNode::~StrokeNode() {
+  if (batch_)
+    batch_->RemoveStroke(this);
+  CC_SAFE_RELEASE(texture_);
+}
+
+StrokeNode* StrokeNode::create(CCTexture2D* texture, float thickness) {
+  StrokeNode* node = new StrokeNode();
+  if (!node->initWithTexture(texture, thickness)) {
+    delete node;
+    return NULL;
+  }
+  node->autorelease();
+  return node;
+}
+
+bool StrokeNode::initWithTexture(CCTexture2D* texture, float thickness) {
+  if (!CCNode::init())
+    return false;
+  assert(texture);
+  texture_ = texture;
+  texture_->retain();
+  thickness_ = thickness;
+  CCShaderCache* shaders = CCShaderCache::sharedShaderCache();
+  setShaderProgram(shaders->programForKey(kCCShader_PositionTextureColor));
+  return true;
+}
+
+void StrokeNode::AddPoint(const CCPoint& point, const ccColor3B& color) {
+  if (polylines_.empty() || polylines_.back().closed)
+    polylines_.push_back(Polyline());
+
+  Polyline& polyline = polylines_.back();
+  // Repeated points would give segments with no direction.
+  if (!polyline.points.empty() && polyline.points.back().equals(point))
+    return;
+  polyline.points.push_back(point);
+  polyline.colors.push_back(ccc4(color.r, color.g, color.b, 255));
+  SetMeshDirty();
+}
+
+void StrokeNode::AddLine(const CCPoint& from, const CCPoint& to,
+                         const ccColor3B& color) {
+  bool extends = !polylines_.empty() && !polylines_.back().closed &&
+                 !polylines_.back().points.empty() &&
+                 polylines_.back().points.back().equals(from);
+  if (!extends) {
+    polylines_.push_back(Polyline());
+    AddPoint(from, color);
+  }
+  AddPoint(to, color);
+}
+
+void StrokeNode::ClosePolyline() {
+  if (polylines_.empty())
+    return;
+  polylines_.back().closed = true;
+  SetMeshDirty();
+}
+
+void StrokeNode::Clear() {
+  polylines_.clear();
+  vertices_.clear();
+  built_polylines_ = 0;
+  changed_from_ = 0;
+  SetMeshDirty();
+}
+
+void StrokeNode::SetMeshDirty() {
+  mesh_dirty_ = true;
+  if (batch_)
+    batch_->SetStrokeDirty(batch_index_);
+}
+
+int StrokeNode::GetPointCount() {
+  int count = 0;
+  for (size_t i = 0; i < polylines_.size(); i++)
+    count += polylines_[i].points.size();
+  return count;
+}
+
+const std::vector<ccV2F_C4B_T2F>& StrokeNode::GetVertices() {
+  if (mesh_dirty_)
+    UpdateMesh();
+  return vertices_;
+}
+
+void StrokeNode::UpdateMesh() {
+  // Points are only ever added to (and polylines closed at) the end,
+  // so only the last built polyline can have changed and the rest are
+  // new.
+  size_t index = built_polylines_;
+  if (index) {
+    const Polyline& last = polylines_[index - 1];
+    if (last.mesh_points != last.points.size() ||
+        last.mesh_closed != last.closed)
+      index--;
+  }
+
+  if (index < polylines_.size()) {
+    const Polyline& polyline = polylines_[index];
+    bool extend = index < built_polylines_ && !polyline.closed &&
+                  !polyline.mesh_closed && polyline.mesh_points >= 2;
+    if (extend) {
+      ExtendPolylineMesh(index);
+      index++;
+    } else {
+      if (index < built_polylines_)
+        vertices_.resize(polyline.mesh_start);
+      changed_from_ = MIN(changed_from_, vertices_.size());
+    }
+    for (; index < polylines_.size(); index++)
+      AddPolylineMesh(index);
+    built_polylines_ = polylines_.size();
+  }
+  mesh_dirty_ = false;
+}
+
+static ccV2F_C4B_T2F MakeVertex(const CCPoint& pos, const ccColor4B& color,
+                                float u, float v) {
+  ccV2F_C4B_T2F vertex;
+  vertex.vertices = vertex2(pos.x, pos.y);
+  vertex.colors = color;
+  vertex.texCoords = tex2(u, v);
+  return vertex;
+}
+
+void StrokeNode::AddQuad(const ccV2F_C4B_T2F& a, const ccV2F_C4B_T2F& b,
+                         const ccV2F_C4B_T2F& c, const ccV2F_C4B_T2F& d) {
+  vertices_.push_back(a);
+  vertices_.push_back(b);
+  vertices_.push_back(c);
+  vertices_.push_back(b);
+  vertices_.push_back(d);
+  vertices_.push_back(c);
+}
+
+void StrokeNode::AddCap(const CCPoint& center, const ccColor4B& color) {
+  float s = texture_->getMaxS();
+  float t = texture_->getMaxT();
+  float x0 = center.x - thickness_;
+  float x1 = center.x + thickness_;
+  float y0 = center.y - thickness_;
+  float y1 = center.y + thickness_;
+  AddQuad(MakeVertex(ccp(x0, y0), color, 0, t),
+          MakeVertex(ccp(x1, y0), color, s, t),
+          MakeVertex(ccp(x0, y1), color, 0, 0),
+          MakeVertex(ccp(x1, y1), color, s, 0));
+}
+
+CCPoint StrokeNode::GetOffset(const Polyline& polyline, size_t i,
+                             size_t count, bool closed) {
+  const PointList& points = polyline.points;
+  size_t num_segments = closed ? count : count - 1;
+  bool has_prev = closed || i > 0;
+  bool has_next = closed || i < count - 1;
+  // Left hand normals of the segments before and after the point.
+  size_t prev_segment = (i + num_segments - 1) % num_segments;
+  size_t next_segment = i % num_segments;
+  CCPoint prev = ccpNormalize(ccpPerp(ccpSub(
+      points[(prev_segment + 1) % count], points[prev_segment])));
+  CCPoint next = ccpNormalize(ccpPerp(ccpSub(
+      points[(next_segment + 1) % count], points[next_segment])));
+  if (!has_prev)
+    return ccpMult(next, thickness_);
+  if (!has_next)
+    return ccpMult(prev, thickness_);
+
+  // Joints use the average of the two normals, scaled so that the
+  // stroke keeps its width through the turn.
+  CCPoint miter = ccpAdd(prev, next);
+  if (ccpLengthSQ(miter) < 1e-6f) {
+    // The stroke doubles back on itself.
+    return ccpMult(prev, thickness_);
+  }
+  miter = ccpNormalize(miter);
+  float scale = MIN(1.0f / ccpDot(miter, prev), MAX_MITER_SCALE);
+  return ccpMult(miter, thickness_ * scale);
+}
+
+void StrokeNode::AddSegment(const Polyline& polyline, size_t i,
+                            size_t count, bool closed) {
+  const PointList& points = polyline.points;
+  size_t j = (i + 1) % count;
+  CCPoint offset_i = GetOffset(polyline, i, count, closed);
+  CCPoint offset_j = GetOffset(polyline, j, count, closed);
+  // The body of the stroke samples the middle column of the brush so
+  // its edges fade the same way as the brush does.
+  float u = texture_->getMaxS() / 2;
+  float t = texture_->getMaxT();
+  AddQuad(MakeVertex(ccpAdd(points[i], offset_i), polyline.colors[i], u, 0),
+          MakeVertex(ccpSub(points[i], offset_i), polyline.colors[i], u, t),
+          MakeVertex(ccpAdd(points[j], offset_j), polyline.colors[j], u, 0),
+          MakeVertex(ccpSub(points[j], offset_j), polyline.colors[j], u, t));
+}
+
+void StrokeNode::AddPolylineMesh(size_t index) {
+  Polyline& polyline = polylines_[index];
+  const PointList& points = polyline.points;
+  size_t count = points.size();
+  polyline.mesh_start = vertices_.size();
+  polyline.mesh_points = count;
+  polyline.mesh_closed = polyline.closed;
+  if (!count)
+    return;
+  if (count == 1) {
+    AddCap(points[0], polyline.colors[0]);
+    return;
+  }
+
+  // Open polylines are laid out as start cap, segments, end cap so
+  // that extending them only changes the end of the mesh.
+  bool closed = polyline.closed && count > 2;
+  if (!closed)
+    AddCap(points[0], polyline.colors[0]);
+  size_t num_segments = closed ? count : count - 1;
+  for (size_t i = 0; i < num_segments; i++)
+    AddSegment(polyline, i, count, closed);
+  if (!closed)
+    AddCap(points[count - 1], polyline.colors[count - 1]);
+}
+
+void StrokeNode::ExtendPolylineMesh(size_t index) {
+  Polyline& polyline = polylines_[index];
+  const PointList& points = polyline.points;
+  changed_from_ = MIN(changed_from_, vertices_.size() - 2 * QUAD_VERTICES);
+  for (size_t count = polyline.mesh_points + 1; count <= points.size();
+       count++) {
+    // Drop the end cap and the last segment, whose end becomes a joint.
+    vertices_.resize(vertices_.size() - 2 * QUAD_VERTICES);
+    AddSegment(polyline, count - 3, count, false);
+    AddSegment(polyline, count - 2, count, false);
+    AddCap(points[count - 1], polyline.colors[count - 1]);
+  }
+  polyline.mesh_points = points.size();
+}
+
+void StrokeNode::draw() {
+  if (batch_)
+    return;
+  const std::vector<ccV2F_C4B_T2F>& vertices = GetVertices();
+  if (vertices.empty())
+    return;
+
+  CC_NODE_DRAW_SETUP();
+  DrawVertices(texture_, &vertices[0], vertices.size());
+}
+
+void StrokeNode::DrawVertices(CCTexture2D* texture,
+                              const ccV2F_C4B_T2F* vertices, int count) {
+  if (texture->hasPremultipliedAlpha())
+    ccGLBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  else
+    ccGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  ccGLBindTexture2D(texture->getName());
+  ccGLEnableVertexAttribs(kCCVertexAttribFlag_PosColorTex);
+
+  const char* base = reinterpret_cast<const char*>(vertices);
+  GLsizei stride = sizeof(ccV2F_C4B_T2F);
+  glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE,
+                        stride, base + offsetof(ccV2F_C4B_T2F, vertices));
+  glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                        stride, base + offsetof(ccV2F_C4B_T2F, colors));
+  glVertexAttribPointer(kCCVertexAttrib_TexCoords, 2, GL_FLOAT, GL_FALSE,
+                        stride, base + offsetof(ccV2F_C4B_T2F, texCoords));
+  glDrawArrays(GL_TRIANGLES, 0, count);
+  CC_INCREMENT_GL_DRAWS(1);
+}
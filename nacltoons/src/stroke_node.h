@@ -0,0 +1,133 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef STROKE_NODE_H_
+#define STROKE_NODE_H_
+
+#include <vector>
+
+#include "cocos2d.h"
+#include "geometry.h"
+
+USING_NS_CC;
+
+class StrokeBatch;
+
+/**
+ * Node that draws brush strokes.  Each stroke is a polyline which is
+ * rendered as a single textured triangle mesh: the body of the stroke
+ * uses a slice through the middle of the brush texture, and the ends
+ * of open strokes are capped with the whole brush.  All the polylines
+ * in a node are drawn with one draw call, so a drawn shape needs a
+ * single node no matter how long its strokes are.  Nodes that are
+ * added to a StrokeBatch are drawn by the batch instead.
+ *
+ * The mesh is updated incrementally.  Points can only be added to the
+ * last polyline, so only the end of the mesh changes: extending an
+ * open polyline rewrites its last segment and end cap and appends the
+ * new segment, so drawing a stroke point by point costs O(1) per point.
+ */
+class StrokeNode : public CCNode {
+ public:
+  StrokeNode();
+  ~StrokeNode();
+
+  // Create a node that draws with 'texture'.  'thickness' is half the
+  // width of the stroke in points.
+  static StrokeNode* create(CCTexture2D* texture, float thickness);
+  bool initWithTexture(CCTexture2D* texture, float thickness);
+
+  // Append a point to the current polyline, starting a new one if
+  // the current polyline is closed.
+  void AddPoint(const CCPoint& point, const ccColor3B& color);
+
+  // Add a line segment.  This extends the current polyline if it ends
+  // at 'from' and starts a new polyline otherwise.
+  void AddLine(const CCPoint& from, const CCPoint& to,
+               const ccColor3B& color);
+
+  // Join the end of the current polyline back to its start.  The next
+  // point added starts a new polyline.
+  void ClosePolyline();
+
+  // Remove all polylines.
+  void Clear();
+
+  int GetPointCount();
+
+  // The mesh in node space, as a list of triangles.  Each polyline's
+  // triangles follow those of the polylines before it.
+  const std::vector<ccV2F_C4B_T2F>& GetVertices();
+
+  StrokeBatch* GetBatch() { return batch_; }
+
+  virtual void draw();
+
+  // Draw 'count' triangle vertices with 'texture'.  The caller must
+  // have set up the node's shader and transform.
+  static void DrawVertices(CCTexture2D* texture,
+                           const ccV2F_C4B_T2F* vertices, int count);
+
+ private:
+  friend class StrokeBatch;
+
+  // Flag the mesh for updating and let the batch know that this
+  // stroke's vertices need rewriting.
+  void SetMeshDirty();
+
+  struct Polyline {
+    Polyline() : closed(false), mesh_start(0), mesh_points(0),
+                 mesh_closed(false) {}
+    PointList points;
+    std::vector<ccColor4B> colors;
+    bool closed;
+    // First vertex of the polyline's mesh, and the number of points
+    // and closed state the mesh was built with.
+    size_t mesh_start;
+    size_t mesh_points;
+    bool mesh_closed;
+  };
+
+  // Bring vertices_ up to date with polylines_.  Polylines whose mesh
+  // is current are left alone.
+  void UpdateMesh();
+
+  // Build the mesh of the polyline at 'index' at the end of vertices_.
+  void AddPolylineMesh(size_t index);
+
+  // Add the points of an open polyline that were added since its mesh
+  // was built.  Its mesh must be at the end of vertices_ and have at
+  // least two points.
+  void ExtendPolylineMesh(size_t index);
+
+  // Offset from point 'i' to the left edge of the stroke when the
+  // polyline has its first 'count' points.
+  CCPoint GetOffset(const Polyline& polyline, size_t i, size_t count,
+                    bool closed);
+
+  // Add the quad for the segment from point 'i' to the next point.
+  void AddSegment(const Polyline& polyline, size_t i, size_t count,
+                  bool closed);
+  void AddCap(const CCPoint& center, const ccColor4B& color);
+  void AddQuad(const ccV2F_C4B_T2F& a, const ccV2F_C4B_T2F& b,
+               const ccV2F_C4B_T2F& c, const ccV2F_C4B_T2F& d);
+
+  CCTexture2D* texture_;
+  float thickness_;
+  std::vector<Polyline> polylines_;
+
+  // Triangles for all polylines, updated when mesh_dirty_ is set.
+  std::vector<ccV2F_C4B_T2F> vertices_;
+  bool mesh_dirty_;
+  // Number of polylines (from the start) whose mesh is in vertices_.
+  size_t built_polylines_;
+  // First vertex that changed since the batch last copied the mesh.
+  size_t changed_from_;
+
+  // Batch that draws this node, or NULL if the node draws itself, and
+  // the node's index in the batch.
+  StrokeBatch* batch_;
+  int batch_index_;
+};
+
+#endif  // STROKE_NODE_H_
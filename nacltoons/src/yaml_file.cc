@@ -0,0 +1,313 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "yaml_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "yaml.h"
+
+extern "C" {
+#include "lua.h"
+#include "lauxlib.h"
+}
+
+// Stack slots used while loading (slot 1 holds the filename).
+#define VALUES_INDEX 2
+#define ANCHORS_INDEX 3
+#define NULL_INDEX 4
+
+// Tags which ask for a scalar to be loaded as a particular type.
+#define TAG_PREFIX "tag:yaml.org,2002:"
+
+// An open sequence or mapping.  Its values are kept in the values
+// table at (base, values_top] until it ends.
+struct Container {
+  bool mapping;
+  int base;
+  std::string anchor;
+};
+
+class Loader {
+ public:
+  explicit Loader(lua_State* L) :
+      L_(L),
+      values_top_(0),
+      documents_(0),
+      error_(NULL),
+      line_(0),
+      column_(0) {
+  }
+
+  // Parse everything in 'file', leaving each document on the stack.
+  bool Load(FILE* file);
+
+  int documents() { return documents_; }
+  const char* error() { return error_; }
+  int line() { return line_; }
+  int column() { return column_; }
+
+ private:
+  bool Fail(const char* error, const yaml_mark_t& mark) {
+    error_ = error;
+    line_ = mark.line + 1;
+    column_ = mark.column + 1;
+    return false;
+  }
+
+  bool HandleEvent(const yaml_event_t& event);
+  void PushScalar(const yaml_event_t& event);
+  void EndContainer();
+  void SetAnchor(const char* anchor);
+
+  // Add the value on top of the stack to the innermost container.
+  void AddValue();
+
+  lua_State* L_;
+  std::vector<Container> containers_;
+  int values_top_;
+  int documents_;
+  const char* error_;
+  int line_;
+  int column_;
+};
+
+bool Loader::Load(FILE* file) {
+  yaml_parser_t parser;
+  if (!yaml_parser_initialize(&parser)) {
+    error_ = "could not create yaml parser";
+    return false;
+  }
+  yaml_parser_set_input_file(&parser, file);
+
+  bool ok = true;
+  bool done = false;
+  while (ok && !done) {
+    yaml_event_t event;
+    if (!yaml_parser_parse(&parser, &event)) {
+      ok = Fail(parser.problem ? parser.problem : "invalid yaml",
+                parser.problem_mark);
+      break;
+    }
+    done = event.type == YAML_STREAM_END_EVENT;
+    ok = HandleEvent(event);
+    yaml_event_delete(&event);
+  }
+
+  yaml_parser_delete(&parser);
+  return ok;
+}
+
+bool Loader::HandleEvent(const yaml_event_t& event) {
+  switch (event.type) {
+    case YAML_SCALAR_EVENT:
+      PushScalar(event);
+      SetAnchor(reinterpret_cast<const char*>(event.data.scalar.anchor));
+      AddValue();
+      break;
+    case YAML_ALIAS_EVENT:
+      lua_getfield(L_, ANCHORS_INDEX,
+                   reinterpret_cast<const char*>(event.data.alias.anchor));
+      if (lua_isnil(L_, -1)) {
+        lua_pop(L_, 1);
+        return Fail("unknown or unfinished anchor", event.start_mark);
+      }
+      AddValue();
+      break;
+    case YAML_SEQUENCE_START_EVENT:
+    case YAML_MAPPING_START_EVENT: {
+      bool mapping = event.type == YAML_MAPPING_START_EVENT;
+      const yaml_char_t* anchor = mapping ?
+          event.data.mapping_start.anchor : event.data.sequence_start.anchor;
+      Container container;
+      container.mapping = mapping;
+      container.base = values_top_;
+      if (anchor)
+        container.anchor = reinterpret_cast<const char*>(anchor);
+      containers_.push_back(container);
+      break;
+    }
+    case YAML_SEQUENCE_END_EVENT:
+    case YAML_MAPPING_END_EVENT:
+      EndContainer();
+      break;
+    case YAML_DOCUMENT_START_EVENT:
+      // Each document is left on the stack.
+      if (!lua_checkstack(L_, 2))
+        return Fail("too many documents", event.start_mark);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void Loader::PushScalar(const yaml_event_t& event) {
+  const char* value = reinterpret_cast<const char*>(event.data.scalar.value);
+  size_t length = event.data.scalar.length;
+  const char* tag = reinterpret_cast<const char*>(event.data.scalar.tag);
+
+  if (tag && !strncmp(tag, TAG_PREFIX, strlen(TAG_PREFIX))) {
+    tag += strlen(TAG_PREFIX);
+    if (!strcmp(tag, "str")) {
+      lua_pushlstring(L_, value, length);
+      return;
+    }
+    if (!strcmp(tag, "int")) {
+      lua_pushnumber(L_, strtol(value, NULL, 10));
+      return;
+    }
+    if (!strcmp(tag, "float")) {
+      lua_pushnumber(L_, strtod(value, NULL));
+      return;
+    }
+    if (!strcmp(tag, "bool")) {
+      lua_pushboolean(L_, !strcmp(value, "true") || !strcmp(value, "yes"));
+      return;
+    }
+    if (!strcmp(tag, "null")) {
+      lua_pushvalue(L_, NULL_INDEX);
+      return;
+    }
+  }
+
+  // Only plain scalars are resolved; quoted ones are always strings.
+  if (event.data.scalar.style == YAML_PLAIN_SCALAR_STYLE && length) {
+    if (!strcmp(value, "~") || !strcmp(value, "null")) {
+      lua_pushvalue(L_, NULL_INDEX);
+      return;
+    }
+    if (!strcmp(value, "true") || !strcmp(value, "yes")) {
+      lua_pushboolean(L_, 1);
+      return;
+    }
+    if (!strcmp(value, "false") || !strcmp(value, "no")) {
+      lua_pushboolean(L_, 0);
+      return;
+    }
+    char* end;
+    double number = strtod(value, &end);
+    if (end == value + length) {
+      lua_pushnumber(L_, number);
+      return;
+    }
+  }
+
+  lua_pushlstring(L_, value, length);
+}
+
+void Loader::EndContainer() {
+  Container container = containers_.back();
+  containers_.pop_back();
+
+  // The table is created with room for exactly the values collected.
+  int count = values_top_ - container.base;
+  if (container.mapping) {
+    lua_createtable(L_, 0, count / 2);
+    for (int i = container.base + 1; i < values_top_; i += 2) {
+      lua_rawgeti(L_, VALUES_INDEX, i);
+      // Null keys can't be stored in a lua table.
+      if (lua_isnil(L_, -1) ||
+          (lua_isnumber(L_, -1) &&
+           lua_tonumber(L_, -1) != lua_tonumber(L_, -1))) {
+        lua_pop(L_, 1);
+        continue;
+      }
+      lua_rawgeti(L_, VALUES_INDEX, i + 1);
+      lua_rawset(L_, -3);
+    }
+  } else {
+    lua_createtable(L_, count, 0);
+    for (int i = 1; i <= count; i++) {
+      lua_rawgeti(L_, VALUES_INDEX, container.base + i);
+      lua_rawseti(L_, -2, i);
+    }
+  }
+  // The collected values are left in the values table to be
+  // overwritten.  They are all referenced by the new table anyway.
+  values_top_ = container.base;
+
+  if (!container.anchor.empty())
+    SetAnchor(container.anchor.c_str());
+  AddValue();
+}
+
+void Loader::SetAnchor(const char* anchor) {
+  if (!anchor)
+    return;
+  lua_pushvalue(L_, -1);
+  lua_setfield(L_, ANCHORS_INDEX, anchor);
+}
+
+void Loader::AddValue() {
+  if (containers_.empty()) {
+    // A document's root value stays on the stack.
+    documents_++;
+    return;
+  }
+  lua_rawseti(L_, VALUES_INDEX, ++values_top_);
+}
+
+static int Load(lua_State* L) {
+  const char* filename = luaL_checkstring(L, 1);
+  lua_settop(L, 1);
+  lua_newtable(L);  // VALUES_INDEX
+  lua_newtable(L);  // ANCHORS_INDEX
+
+  // Nulls are loaded as yaml.null, as lua-yaml does.
+  lua_getglobal(L, "package");
+  lua_getfield(L, -1, "loaded");
+  lua_getfield(L, -1, "yaml");
+  if (lua_istable(L, -1))
+    lua_getfield(L, -1, "null");
+  else
+    lua_pushnil(L);
+  lua_replace(L, NULL_INDEX);
+  lua_settop(L, NULL_INDEX);
+
+  const char* error = NULL;
+  int line = 0;
+  int column = 0;
+  int documents = 0;
+  {
+    // Scoped so that everything is cleaned up before luaL_error, which
+    // doesn't return.
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+      error = "could not read file";
+    } else {
+      Loader loader(L);
+      if (!loader.Load(file)) {
+        error = loader.error();
+        line = loader.line();
+        column = loader.column();
+      }
+      documents = loader.documents();
+      fclose(file);
+    }
+  }
+
+  if (error) {
+    lua_settop(L, NULL_INDEX);
+    if (line)
+      return luaL_error(L, "Error in '%s': %s at line %d, column %d",
+                        filename, error, line, column);
+    return luaL_error(L, "Error in '%s': %s", filename, error);
+  }
+  return documents;
+}
+
+static const luaL_Reg yamlfile_functions[] = {
+  { "load", Load },
+  { NULL, NULL }
+};
+
+int luaopen_yamlfile(lua_State* L) {
+  luaL_register(L, "yamlfile", yamlfile_functions);
+  return 1;
+}
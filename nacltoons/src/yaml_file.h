@@ -0,0 +1,25 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef YAML_FILE_H_
+#define YAML_FILE_H_
+
+struct lua_State;
+
+/**
+ * Registers the 'yamlfile' lua module:
+ *
+ *   yamlfile.load(filename)  returns the document(s) in filename
+ *
+ * Unlike yaml.load this doesn't need the whole file in a lua string.
+ * libyaml reads the file in small blocks and its events are turned
+ * straight into lua values.  The values of each sequence and mapping
+ * are collected first so that its table can be created at its final
+ * size.  Scalars are resolved in the same way as lua-yaml: numbers,
+ * booleans (true/yes, false/no), nulls (~/null, loaded as yaml.null)
+ * and strings.  Anchors and aliases are supported, except for aliases
+ * to a sequence or mapping from inside itself.
+ */
+int luaopen_yamlfile(lua_State* L);
+
+#endif  // YAML_FILE_H_
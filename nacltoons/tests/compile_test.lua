@@ -0,0 +1,57 @@
+-- Copyright (c) 2013 The Chromium Authors. All rights reserved.
+-- Use of this source code is governed by a BSD-style license that can be
+-- found in the LICENSE file.
+
+require "lunit"
+
+module("compile_test", lunit.testcase, package.seeall)
+
+compile = require "compile"
+util = require "util"
+yaml = require "yaml"
+
+-- Header for an empty source file: its size and Adler-32 checksum.
+HEADER = 'NTLV\2' .. '\0\0\0\0' .. '\1\0\0\0'
+
+function test_EncodeScalars()
+    assert_equal(HEADER .. 'T', compile.Encode(true))
+    assert_equal(HEADER .. 'F', compile.Encode(false))
+    assert_equal(HEADER .. 's\3\0\0\0foo', compile.Encode('foo'))
+end
+
+function test_EncodeNumbers()
+    assert_equal(HEADER .. 'i\1\1\0\0', compile.Encode(257))
+    assert_equal(HEADER .. 'i\255\255\255\255', compile.Encode(-1))
+    assert_equal(HEADER .. 'd\3' .. '0.5', compile.Encode(0.5))
+end
+
+function test_EncodeTable()
+    expected = HEADER .. 't\2\0\0\0\1\0\0\0' ..
+               'i\1\0\0\0' .. 'i\2\0\0\0' ..
+               's\3\0\0\0key' .. 's\5\0\0\0value'
+    assert_equal(expected, compile.Encode({ 1, 2, key = 'value' }))
+end
+
+function test_EncodeSourceChecksum()
+    -- Adler-32 of 'abc' is 0x024d0127.
+    assert_equal('NTLV\2' .. '\3\0\0\0' .. '\39\1\77\2' .. 'T',
+                 compile.Encode(true, 'abc'))
+end
+
+function test_EncodeNull()
+    assert_equal(HEADER .. 'N', compile.Encode(yaml.null))
+end
+
+function test_EncodeInvalid()
+    assert_error(function() compile.Encode({ f = print }) end)
+end
+
+function test_EncodeInvalidNamesKey()
+    local ok, message = pcall(compile.Encode, { shapes = { { pos = print } } })
+    assert_false(ok)
+    assert_not_nil(message:find('<root>.shapes[1].pos', 1, true))
+end
+
+function test_CompiledFilename()
+    assert_equal('game/level1.bin', util.CompiledFilename('game/level1.def'))
+end
@@ -0,0 +1,153 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Tests for the polygon helpers in src/geometry.cc.  These are built
+// with the headless build: make -C proj.headless test
+#include <stdio.h>
+
+#include "geometry.h"
+
+USING_NS_CC;
+
+static int g_failures = 0;
+
+#define EXPECT(cond) \
+  do { \
+    if (!(cond)) { \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond); \
+      g_failures++; \
+    } \
+  } while (0)
+
+static const float kTolerance = 0.5f;
+
+// Returns true if any vertex of 'piece' is within 'tolerance' of the
+// line through its neighbours.
+static bool HasCollinearVertex(const PointList& piece, float tolerance) {
+  size_t n = piece.size();
+  for (size_t i = 0; i < n; i++) {
+    const CCPoint& prev = piece[(i + n - 1) % n];
+    const CCPoint& cur = piece[i];
+    const CCPoint& next = piece[(i + 1) % n];
+    float cross = (cur.x - prev.x) * (next.y - prev.y) -
+                  (cur.y - prev.y) * (next.x - prev.x);
+    if (fabsf(cross) <= tolerance * ccpDistance(prev, next))
+      return true;
+  }
+  return false;
+}
+
+static float TotalArea(const std::vector<PointList>& pieces) {
+  float area = 0;
+  for (size_t i = 0; i < pieces.size(); i++)
+    area += PolygonArea(pieces[i]);
+  return area;
+}
+
+static void CheckPieces(const std::vector<PointList>& pieces,
+                        int max_vertices) {
+  for (size_t i = 0; i < pieces.size(); i++) {
+    EXPECT(pieces[i].size() >= 3);
+    EXPECT(pieces[i].size() <= (size_t)max_vertices);
+    EXPECT(PolygonArea(pieces[i]) > 0);
+    EXPECT(!HasCollinearVertex(pieces[i], kTolerance));
+  }
+}
+
+// A square with extra points along every edge, and a duplicate corner,
+// as a slow freehand stroke produces.
+static void TestCollinearSquare() {
+  PointList square;
+  for (int i = 0; i < 10; i++)
+    square.push_back(ccp(i * 10, 0));
+  for (int i = 0; i < 10; i++)
+    square.push_back(ccp(100, i * 10));
+  square.push_back(ccp(100, 100));
+  square.push_back(ccp(100.1f, 100));
+  for (int i = 0; i < 10; i++)
+    square.push_back(ccp(100 - i * 10, 100));
+  for (int i = 0; i < 10; i++)
+    square.push_back(ccp(0, 100 - i * 10));
+
+  std::vector<PointList> pieces;
+  EXPECT(DecomposePolygon(square, 8, kTolerance, &pieces));
+  EXPECT(pieces.size() == 1);
+  if (pieces.size() == 1)
+    EXPECT(pieces[0].size() == 4);
+  CheckPieces(pieces, 8);
+  EXPECT(fabsf(TotalArea(pieces) - 10000) < 1);
+}
+
+// An L shape whose inner corner lines up with the outer edges, so
+// merging the triangles leaves collinear vertices.
+static void TestCollinearAfterMerge() {
+  PointList shape;
+  shape.push_back(ccp(0, 0));
+  shape.push_back(ccp(200, 0));
+  shape.push_back(ccp(200, 100));
+  shape.push_back(ccp(100, 100));
+  shape.push_back(ccp(100, 200));
+  shape.push_back(ccp(0, 200));
+
+  std::vector<PointList> pieces;
+  EXPECT(DecomposePolygon(shape, 8, kTolerance, &pieces));
+  EXPECT(pieces.size() == 2);
+  CheckPieces(pieces, 8);
+  EXPECT(fabsf(TotalArea(pieces) - 30000) < 1);
+}
+
+// A circle with more vertices than a single piece may have.
+static void TestVertexLimit() {
+  PointList circle;
+  for (int i = 0; i < 40; i++) {
+    float angle = 2 * M_PI * i / 40;
+    circle.push_back(ccp(100 * cosf(angle), 100 * sinf(angle)));
+  }
+
+  std::vector<PointList> pieces;
+  EXPECT(DecomposePolygon(circle, 8, kTolerance, &pieces));
+  EXPECT(pieces.size() > 1);
+  CheckPieces(pieces, 8);
+  EXPECT(fabsf(TotalArea(pieces) - PolygonArea(circle)) < 1);
+}
+
+// A clockwise outline is decomposed into counter-clockwise pieces.
+static void TestClockwise() {
+  PointList triangle;
+  triangle.push_back(ccp(0, 0));
+  triangle.push_back(ccp(0, 100));
+  triangle.push_back(ccp(0, 100.1f));
+  triangle.push_back(ccp(100, 0));
+
+  std::vector<PointList> pieces;
+  EXPECT(DecomposePolygon(triangle, 8, kTolerance, &pieces));
+  EXPECT(pieces.size() == 1);
+  CheckPieces(pieces, 8);
+}
+
+static void TestSelfIntersecting() {
+  PointList bowtie;
+  bowtie.push_back(ccp(0, 0));
+  bowtie.push_back(ccp(100, 100));
+  bowtie.push_back(ccp(100, 0));
+  bowtie.push_back(ccp(0, 100));
+
+  std::vector<PointList> pieces;
+  EXPECT(!DecomposePolygon(bowtie, 8, kTolerance, &pieces));
+  EXPECT(pieces.empty());
+}
+
+int main() {
+  TestCollinearSquare();
+  TestCollinearAfterMerge();
+  TestVertexLimit();
+  TestClockwise();
+  TestSelfIntersecting();
+  if (g_failures) {
+    fprintf(stderr, "%d failures\n", g_failures);
+    return 1;
+  }
+  printf("geometry_test: OK\n");
+  return 0;
+}
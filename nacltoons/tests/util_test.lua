@@ -48,3 +48,29 @@ function test_TableToYamlOneLine()
     result = util.TableToYamlOneLine(test_table)
     assert_equal(expected, result)
 end
+
+function test_GetPngSize()
+    width, height = util.GetPngSize('data/res/sample_game/images/ball.png')
+    assert_equal(50, width)
+    assert_equal(50, height)
+end
+
+function test_GetPngSizeNotPng()
+    local function doError()
+        util.GetPngSize('data/res/sample_game/game.def')
+    end
+    assert_error("non-png file failed to generate error", doError)
+end
+
+function test_DeepCopy()
+    shared = { 1, 2 }
+    original = { a = shared, b = shared, c = { d = 'e' } }
+    copy = util.DeepCopy(original)
+    assert_not_equal(original, copy)
+    assert_not_equal(original.c, copy.c)
+    assert_equal('e', copy.c.d)
+    assert_equal(copy.a, copy.b)
+    assert_not_equal(shared, copy.a)
+    copy.a[1] = 3
+    assert_equal(1, shared[1])
+end
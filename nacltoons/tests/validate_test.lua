@@ -29,3 +29,71 @@ function test_LevelDefInvalidKey()
     end
     assert_error("invalid key failed to generate error", doError)
 end
+
+function test_LevelDefSize()
+    validate.ValidateLevelDef('dummylevel.def', { }, { size = { 2400, 600 } })
+end
+
+function test_LevelDefInvalidSize()
+    local function doError()
+        validate.ValidateLevelDef('dummylevel.def', { }, { size = { 2400 } })
+    end
+    assert_error("invalid size failed to generate error", doError)
+end
+
+function test_LevelDefShapes()
+    local shapes = { { type = 'line' }, { { type = 'edge' }, { type = 'image' } } }
+    validate.ValidateLevelDef('dummylevel.def', { }, { shapes = shapes })
+end
+
+function test_LevelDefInvalidShapeType()
+    local function doError()
+        validate.ValidateLevelDef('dummylevel.def', { }, { shapes = { { type = 'circle' } } })
+    end
+    assert_error("invalid shape type failed to generate error", doError)
+end
+
+function test_IsValidatedWithoutStamp()
+    assert_false(validate.IsValidated('data/res/sample_game', 'level1.def'))
+end
+
+-- Level files that both validators must agree on.  Files named
+-- valid_*.def must pass and invalid_*.def must fail.
+FIXTURE_DIR = 'tests/data/validate/'
+FIXTURES = {
+    'valid_shapes.def',
+    'valid_empty_shapes.def',
+    'valid_numbered_shapes.def',
+    'invalid_shapes_mapping.def',
+    'invalid_shape_type.def',
+    'invalid_missing_type.def',
+    'invalid_shape_key.def',
+    'invalid_shape_scalar.def',
+    'invalid_empty_shape.def',
+    'invalid_size.def',
+    'invalid_size_mapping.def',
+    'invalid_level_key.def',
+}
+
+-- Built by 'make -C tools', which 'make test' does first.
+NATIVE_VALIDATOR = 'tools/out/validate_defs'
+
+function test_LevelFixtures()
+    local util = require 'util'
+    for _, name in ipairs(FIXTURES) do
+        local filename = FIXTURE_DIR .. name
+        local expected = name:match('^valid_') ~= nil
+        local leveldef = util.LoadYaml(filename)
+        local ok = pcall(validate.ValidateLevelDef, filename, { }, leveldef)
+        assert_equal(expected, ok, 'validate.lua result for ' .. name)
+    end
+end
+
+function test_NativeValidatorAgrees()
+    for _, name in ipairs(FIXTURES) do
+        local filename = FIXTURE_DIR .. name
+        local expected = name:match('^valid_') ~= nil
+        local status = os.execute(NATIVE_VALIDATOR .. ' -l ' .. filename .. ' 2> /dev/null')
+        assert_equal(expected, status == 0, 'validate_defs result for ' .. name)
+    end
+end
@@ -0,0 +1,362 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "def_validator.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// The schema.  These lists must match the ones in validate.lua.
+static const char* const kGameKeys[] = {
+  "assets", "script", "levels", "root", NULL
+};
+static const char* const kRequiredAssets[] = {
+  "level_icon", "level_icon_selected", NULL
+};
+static const char* const kLevelKeys[] = {
+  "num_stars", "shapes", "script", "size", "camera", NULL
+};
+static const char* const kShapeKeys[] = {
+  "script", "pos", "children", "sensor", "image", "start", "finish",
+  "color", "type", "anchor", "tag", "dynamic", NULL
+};
+static const char* const kShapeTypes[] = {
+  "compound", "line", "edge", "image", NULL
+};
+
+// Must be a power of two and more than twice the size of the largest
+// key list, so that probe sequences stay short.
+#define KEY_SET_SLOTS 32
+
+static uint32_t HashKey(const char* key, size_t length) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<unsigned char>(key[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// A fixed set of strings, hashed into an open addressed table so that
+// each key in a .def file is checked with a single hash and (usually)
+// a single comparison.
+class KeySet {
+ public:
+  explicit KeySet(const char* const* keys) {
+    memset(slots_, 0, sizeof(slots_));
+    int count = 0;
+    for (; *keys; keys++) {
+      // Insertion would never find a free slot in a full table.
+      assert(++count * 2 < KEY_SET_SLOTS);
+      size_t length = strlen(*keys);
+      uint32_t i = HashKey(*keys, length) & (KEY_SET_SLOTS - 1);
+      while (slots_[i].key)
+        i = (i + 1) & (KEY_SET_SLOTS - 1);
+      slots_[i].key = *keys;
+      slots_[i].length = length;
+    }
+  }
+
+  bool Contains(const char* key, size_t length) const {
+    uint32_t i = HashKey(key, length) & (KEY_SET_SLOTS - 1);
+    while (slots_[i].key) {
+      if (slots_[i].length == length && !memcmp(slots_[i].key, key, length))
+        return true;
+      i = (i + 1) & (KEY_SET_SLOTS - 1);
+    }
+    return false;
+  }
+
+ private:
+  struct Slot {
+    const char* key;
+    size_t length;
+  };
+  Slot slots_[KEY_SET_SLOTS];
+};
+
+// Built before main() so that they are read-only by the time any
+// validation threads start.
+static const KeySet g_game_keys(kGameKeys);
+static const KeySet g_level_keys(kLevelKeys);
+static const KeySet g_shape_keys(kShapeKeys);
+static const KeySet g_shape_types(kShapeTypes);
+
+static std::string ScalarValue(yaml_node_t* node) {
+  return std::string(reinterpret_cast<const char*>(node->data.scalar.value),
+                     node->data.scalar.length);
+}
+
+// Return the value in a mapping node for the given key, or NULL.
+static yaml_node_t* GetValue(yaml_document_t* document, yaml_node_t* mapping,
+                             const char* key) {
+  size_t length = strlen(key);
+  for (yaml_node_pair_t* pair = mapping->data.mapping.pairs.start;
+       pair < mapping->data.mapping.pairs.top; pair++) {
+    yaml_node_t* key_node = yaml_document_get_node(document, pair->key);
+    if (key_node->type == YAML_SCALAR_NODE &&
+        key_node->data.scalar.length == length &&
+        !memcmp(key_node->data.scalar.value, key, length)) {
+      return yaml_document_get_node(document, pair->value);
+    }
+  }
+  return NULL;
+}
+
+// Return true if a node would be loaded as a lua number.  This matches
+// the scalar resolution of lua-yaml and the yamlfile loader.
+static bool IsNumber(yaml_node_t* node) {
+  if (node->type != YAML_SCALAR_NODE ||
+      node->data.scalar.style != YAML_PLAIN_SCALAR_STYLE ||
+      !node->data.scalar.length) {
+    return false;
+  }
+  const char* value = reinterpret_cast<const char*>(node->data.scalar.value);
+  char* end;
+  strtod(value, &end);
+  return end == value + node->data.scalar.length;
+}
+
+// Get the items of a node that lua would see as a list (see IsList in
+// validate.lua): a sequence, or a mapping whose keys are the numbers
+// 1..n, which includes the empty mapping.  Returns false for anything
+// else.
+static bool GetListItems(yaml_document_t* document, yaml_node_t* node,
+                         std::vector<yaml_node_t*>* items) {
+  items->clear();
+  if (node->type == YAML_SEQUENCE_NODE) {
+    for (yaml_node_item_t* item = node->data.sequence.items.start;
+         item < node->data.sequence.items.top; item++) {
+      items->push_back(yaml_document_get_node(document, *item));
+    }
+    return true;
+  }
+  if (node->type != YAML_MAPPING_NODE)
+    return false;
+
+  size_t count = node->data.mapping.pairs.top - node->data.mapping.pairs.start;
+  items->resize(count, NULL);
+  for (yaml_node_pair_t* pair = node->data.mapping.pairs.start;
+       pair < node->data.mapping.pairs.top; pair++) {
+    yaml_node_t* key = yaml_document_get_node(document, pair->key);
+    if (!IsNumber(key))
+      return false;
+    double number = strtod(
+        reinterpret_cast<const char*>(key->data.scalar.value), NULL);
+    if (number < 1 || number > count)
+      return false;
+    size_t index = static_cast<size_t>(number);
+    if (index != number || (*items)[index - 1])
+      return false;
+    (*items)[index - 1] = yaml_document_get_node(document, pair->value);
+  }
+  return true;
+}
+
+static bool FileExists(const std::string& filename) {
+  struct stat st;
+  return stat(filename.c_str(), &st) == 0;
+}
+
+void DefValidator::CheckValidKeys(yaml_document_t* document,
+                                  yaml_node_t* mapping,
+                                  const KeySet& valid_keys) {
+  for (yaml_node_pair_t* pair = mapping->data.mapping.pairs.start;
+       pair < mapping->data.mapping.pairs.top; pair++) {
+    yaml_node_t* key = yaml_document_get_node(document, pair->key);
+    if (key->type != YAML_SCALAR_NODE) {
+      Error(key->start_mark, "invalid key");
+    } else if (!valid_keys.Contains(
+                   reinterpret_cast<const char*>(key->data.scalar.value),
+                   key->data.scalar.length)) {
+      Error(key->start_mark, "invalid key: " + ScalarValue(key));
+    }
+  }
+}
+
+bool DefValidator::ValidateGame(const std::string& filename,
+                                std::vector<std::string>* levels) {
+  size_t num_errors = errors_.size();
+  yaml_document_t document;
+  yaml_node_t* root = Load(filename, &document);
+  if (root) {
+    CheckGame(&document, root, levels);
+    yaml_document_delete(&document);
+  }
+  return errors_.size() == num_errors;
+}
+
+bool DefValidator::ValidateLevel(const std::string& filename) {
+  size_t num_errors = errors_.size();
+  yaml_document_t document;
+  yaml_node_t* root = Load(filename, &document);
+  if (root) {
+    CheckLevel(&document, root);
+    yaml_document_delete(&document);
+  }
+  return errors_.size() == num_errors;
+}
+
+yaml_node_t* DefValidator::Load(const std::string& filename,
+                                yaml_document_t* document) {
+  filename_ = filename;
+  size_t slash = filename.rfind('/');
+  dirname_ = slash == std::string::npos ? "." : filename.substr(0, slash);
+
+  yaml_mark_t start = { 0, 0, 0 };
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (!file) {
+    Error(start, "could not read file");
+    return NULL;
+  }
+
+  yaml_parser_t parser;
+  if (!yaml_parser_initialize(&parser)) {
+    fclose(file);
+    Error(start, "could not create yaml parser");
+    return NULL;
+  }
+  yaml_parser_set_input_file(&parser, file);
+  bool loaded = yaml_parser_load(&parser, document) != 0;
+  if (!loaded) {
+    Error(parser.problem_mark,
+          parser.problem ? parser.problem : "invalid yaml");
+  }
+  yaml_parser_delete(&parser);
+  fclose(file);
+  if (!loaded)
+    return NULL;
+
+  yaml_node_t* root = yaml_document_get_root_node(document);
+  if (!root) {
+    Error(start, "file is empty");
+    yaml_document_delete(document);
+  }
+  return root;
+}
+
+void DefValidator::CheckGame(yaml_document_t* document, yaml_node_t* root,
+                             std::vector<std::string>* levels) {
+  if (root->type != YAML_MAPPING_NODE) {
+    Error(root->start_mark,
+          "file does not evaluate to an object of type table");
+    return;
+  }
+
+  CheckValidKeys(document, root, g_game_keys);
+
+  yaml_node_t* levels_node = GetValue(document, root, "levels");
+  std::vector<yaml_node_t*> items;
+  if (levels_node) {
+    if (!GetListItems(document, levels_node, &items)) {
+      Error(levels_node->start_mark, "levels must be a list of filenames");
+    } else {
+      for (size_t i = 0; i < items.size(); i++) {
+        if (items[i]->type != YAML_SCALAR_NODE)
+          Error(items[i]->start_mark, "level must be a filename");
+        else
+          levels->push_back(ScalarValue(items[i]));
+      }
+    }
+  }
+
+  yaml_node_t* assets = GetValue(document, root, "assets");
+  if (!assets)
+    return;
+  if (assets->type != YAML_MAPPING_NODE) {
+    Error(assets->start_mark, "assets must be a table");
+    return;
+  }
+
+  for (const char* const* required = kRequiredAssets; *required; required++) {
+    if (!GetValue(document, assets, *required)) {
+      Error(assets->start_mark,
+            std::string("missing required key in asset list : ") + *required);
+    }
+  }
+
+  for (yaml_node_pair_t* pair = assets->data.mapping.pairs.start;
+       pair < assets->data.mapping.pairs.top; pair++) {
+    yaml_node_t* value = yaml_document_get_node(document, pair->value);
+    if (value->type != YAML_SCALAR_NODE) {
+      Error(value->start_mark, "asset must be a filename");
+      continue;
+    }
+    std::string asset = ScalarValue(value);
+    if (!FileExists(dirname_ + "/" + asset))
+      Error(value->start_mark, "asset does not exist: " + asset);
+  }
+}
+
+void DefValidator::CheckLevel(yaml_document_t* document, yaml_node_t* root) {
+  if (root->type != YAML_MAPPING_NODE) {
+    Error(root->start_mark,
+          "file does not evaluate to an object of type 'table'");
+    return;
+  }
+
+  CheckValidKeys(document, root, g_level_keys);
+
+  yaml_node_t* size = GetValue(document, root, "size");
+  if (size) {
+    std::vector<yaml_node_t*> items;
+    bool valid = GetListItems(document, size, &items) && items.size() == 2 &&
+                 IsNumber(items[0]) && IsNumber(items[1]);
+    if (!valid)
+      Error(size->start_mark, "size must be a list of two numbers");
+  }
+
+  yaml_node_t* shapes = GetValue(document, root, "shapes");
+  if (shapes)
+    CheckShapeList(document, shapes);
+}
+
+void DefValidator::CheckShapeList(yaml_document_t* document,
+                                  yaml_node_t* shapes) {
+  std::vector<yaml_node_t*> items;
+  if (!GetListItems(document, shapes, &items)) {
+    Error(shapes->start_mark, "shapes must be a list");
+    return;
+  }
+  // As in validate.lua, any non-empty list in a shape list is a nested
+  // shape list and everything else must be a shape.
+  std::vector<yaml_node_t*> nested;
+  for (size_t i = 0; i < items.size(); i++) {
+    if (GetListItems(document, items[i], &nested) && !nested.empty())
+      CheckShapeList(document, items[i]);
+    else
+      CheckShape(document, items[i]);
+  }
+}
+
+void DefValidator::CheckShape(yaml_document_t* document, yaml_node_t* shape) {
+  if (shape->type != YAML_MAPPING_NODE) {
+    Error(shape->start_mark, "shape must be a table");
+    return;
+  }
+
+  CheckValidKeys(document, shape, g_shape_keys);
+
+  yaml_node_t* type = GetValue(document, shape, "type");
+  if (!type) {
+    Error(shape->start_mark, "missing required key in shape : type");
+  } else if (type->type != YAML_SCALAR_NODE ||
+             !g_shape_types.Contains(
+                 reinterpret_cast<const char*>(type->data.scalar.value),
+                 type->data.scalar.length)) {
+    Error(type->start_mark, "invalid shape type: " +
+          (type->type == YAML_SCALAR_NODE ? ScalarValue(type) : "<table>"));
+  }
+}
+
+void DefValidator::Error(const yaml_mark_t& mark, const std::string& message) {
+  char location[64];
+  snprintf(location, sizeof(location), ":%d:%d: ",
+           static_cast<int>(mark.line) + 1, static_cast<int>(mark.column) + 1);
+  errors_.push_back(filename_ + location + message);
+}
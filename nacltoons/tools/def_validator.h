@@ -0,0 +1,61 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#ifndef DEF_VALIDATOR_H_
+#define DEF_VALIDATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "yaml.h"
+
+class KeySet;
+
+/**
+ * Native version of the checks in data/res/validate.lua.  The schema
+ * (the valid keys of games, levels and shapes) is compiled in as
+ * static tables, and .def files are checked straight from the libyaml
+ * document so that errors can be reported with the line and column of
+ * the offending node.  The two validators must be kept in sync.
+ *
+ * A DefValidator holds no state beyond its list of errors so separate
+ * instances can be used from separate threads.
+ */
+class DefValidator {
+ public:
+  DefValidator() {}
+
+  // Validate a game.def file.  The game's level filenames (relative to
+  // the game.def) are appended to 'levels'.  Returns false if there
+  // were any errors.
+  bool ValidateGame(const std::string& filename,
+                    std::vector<std::string>* levels);
+
+  // Validate a level .def file.  Returns false if there were any errors.
+  bool ValidateLevel(const std::string& filename);
+
+  // Errors found so far, formatted as "filename:line:column: message".
+  const std::vector<std::string>& errors() const { return errors_; }
+
+ private:
+  // Load 'filename' into 'document'.  Returns the root node, or NULL
+  // (having added an error) if the file can't be loaded or is empty.
+  yaml_node_t* Load(const std::string& filename, yaml_document_t* document);
+
+  // Check that all the keys of a mapping are in 'valid_keys'.
+  void CheckValidKeys(yaml_document_t* document, yaml_node_t* mapping,
+                      const KeySet& valid_keys);
+  void CheckGame(yaml_document_t* document, yaml_node_t* root,
+                 std::vector<std::string>* levels);
+  void CheckLevel(yaml_document_t* document, yaml_node_t* root);
+  void CheckShapeList(yaml_document_t* document, yaml_node_t* shapes);
+  void CheckShape(yaml_document_t* document, yaml_node_t* shape);
+
+  void Error(const yaml_mark_t& mark, const std::string& message);
+
+  std::string filename_;
+  std::string dirname_;
+  std::vector<std::string> errors_;
+};
+
+#endif  // DEF_VALIDATOR_H_
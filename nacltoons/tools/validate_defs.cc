@@ -0,0 +1,255 @@
+// Copyright (c) 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Validates every game (and each of its levels) found under the given
+// directories, spreading the work over all cores:
+//
+//   validate_defs [-j jobs] [-w] dir...
+//   validate_defs [-j jobs] -l level.def...
+//
+// Games are found by looking for game.def files.  All games are
+// validated first, then all of the levels they list.  With -l the
+// arguments are level files which are validated on their own.  Errors
+// are printed in a stable order and the exit status is 1 if there were
+// any.
+//
+// With -w a validated.stamp file is written next to each game.def
+// listing the files that passed along with their modification times.
+// The game skips validate.ValidateLevelDef for files in the stamp that
+// haven't changed since (see validate.IsValidated).
+#include <dirent.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "def_validator.h"
+
+#define GAME_FILE "game.def"
+#define STAMP_FILE "validated.stamp"
+// Must match STAMP_HEADER in validate.lua.
+#define STAMP_HEADER "nacltoons validated 1"
+
+struct Task {
+  Task(const std::string& filename, int game) :
+      filename(filename),
+      game(game),
+      ok(false) {
+  }
+
+  std::string filename;
+  // Index of the game this file belongs to.
+  int game;
+  bool ok;
+  std::vector<std::string> errors;
+  // For games, the level filenames relative to the game's directory.
+  std::vector<std::string> levels;
+};
+
+struct WorkQueue {
+  std::vector<Task>* tasks;
+  bool games;
+  size_t next;
+  pthread_mutex_t lock;
+};
+
+static void Usage() {
+  fprintf(stderr, "usage: validate_defs [-j jobs] [-w] dir...\n"
+                  "       validate_defs [-j jobs] -l level.def...\n");
+  exit(1);
+}
+
+static std::string DirName(const std::string& filename) {
+  size_t slash = filename.rfind('/');
+  return slash == std::string::npos ? "." : filename.substr(0, slash);
+}
+
+// Add the game.def files under 'dir' to 'games'.
+static void FindGames(const std::string& dir, std::vector<std::string>* games) {
+  DIR* dirp = opendir(dir.c_str());
+  if (!dirp) {
+    fprintf(stderr, "could not read directory: %s\n", dir.c_str());
+    return;
+  }
+
+  struct dirent* entry;
+  while ((entry = readdir(dirp)) != NULL) {
+    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+      continue;
+    std::string filename = dir + "/" + entry->d_name;
+    struct stat st;
+    if (lstat(filename.c_str(), &st) != 0)
+      continue;
+    if (S_ISDIR(st.st_mode))
+      FindGames(filename, games);
+    else if (S_ISREG(st.st_mode) && !strcmp(entry->d_name, GAME_FILE))
+      games->push_back(filename);
+  }
+  closedir(dirp);
+}
+
+static void* Worker(void* arg) {
+  WorkQueue* queue = static_cast<WorkQueue*>(arg);
+  while (true) {
+    pthread_mutex_lock(&queue->lock);
+    size_t index = queue->next++;
+    pthread_mutex_unlock(&queue->lock);
+    if (index >= queue->tasks->size())
+      break;
+
+    Task& task = (*queue->tasks)[index];
+    DefValidator validator;
+    if (queue->games)
+      task.ok = validator.ValidateGame(task.filename, &task.levels);
+    else
+      task.ok = validator.ValidateLevel(task.filename);
+    task.errors = validator.errors();
+  }
+  return NULL;
+}
+
+// Validate all of 'tasks' using up to 'jobs' threads.
+static void RunTasks(std::vector<Task>* tasks, bool games, int jobs) {
+  WorkQueue queue;
+  queue.tasks = tasks;
+  queue.games = games;
+  queue.next = 0;
+  pthread_mutex_init(&queue.lock, NULL);
+
+  jobs = std::min(jobs, static_cast<int>(tasks->size()));
+  std::vector<pthread_t> threads;
+  for (int i = 0; i < jobs; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, Worker, &queue) != 0)
+      break;
+    threads.push_back(thread);
+  }
+  // Fall back to validating on this thread if no threads were started.
+  if (threads.empty())
+    Worker(&queue);
+  for (size_t i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+
+  pthread_mutex_destroy(&queue.lock);
+}
+
+// Print the errors of each task in order, returning the number printed.
+static int PrintErrors(const std::vector<Task>& tasks) {
+  int num_errors = 0;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    for (size_t j = 0; j < tasks[i].errors.size(); j++)
+      fprintf(stderr, "%s\n", tasks[i].errors[j].c_str());
+    num_errors += tasks[i].errors.size();
+  }
+  return num_errors;
+}
+
+// Write the stamp file for a game listing its files that passed.
+static bool WriteStamp(const std::vector<Task>& games,
+                       const std::vector<Task>& levels, int game) {
+  std::string dir = DirName(games[game].filename);
+  std::string stamp_filename = dir + "/" STAMP_FILE;
+  FILE* file = fopen(stamp_filename.c_str(), "w");
+  if (!file) {
+    fprintf(stderr, "could not write %s\n", stamp_filename.c_str());
+    return false;
+  }
+
+  fprintf(file, "%s\n", STAMP_HEADER);
+  std::vector<const Task*> passed;
+  passed.push_back(&games[game]);
+  for (size_t i = 0; i < levels.size(); i++) {
+    if (levels[i].game == game)
+      passed.push_back(&levels[i]);
+  }
+  for (size_t i = 0; i < passed.size(); i++) {
+    struct stat st;
+    if (!passed[i]->ok || stat(passed[i]->filename.c_str(), &st) != 0)
+      continue;
+    // Filenames are written relative to the game's directory.
+    fprintf(file, "%ld %s\n", static_cast<long>(st.st_mtime),
+            passed[i]->filename.c_str() + dir.size() + 1);
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  int jobs = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+  bool write_stamps = false;
+  bool level_files = false;
+
+  int c;
+  while ((c = getopt(argc, argv, "j:lw")) != -1) {
+    switch (c) {
+      case 'j':
+        jobs = atoi(optarg);
+        break;
+      case 'l':
+        level_files = true;
+        break;
+      case 'w':
+        write_stamps = true;
+        break;
+      default:
+        Usage();
+    }
+  }
+  if (optind >= argc || (level_files && write_stamps))
+    Usage();
+  if (jobs < 1)
+    jobs = 1;
+
+  if (level_files) {
+    std::vector<Task> levels;
+    for (int i = optind; i < argc; i++)
+      levels.push_back(Task(argv[i], 0));
+    RunTasks(&levels, false, jobs);
+    return PrintErrors(levels) ? 1 : 0;
+  }
+
+  std::vector<std::string> game_files;
+  for (int i = optind; i < argc; i++) {
+    std::string dir = argv[i];
+    while (dir.size() > 1 && dir[dir.size() - 1] == '/')
+      dir.erase(dir.size() - 1);
+    FindGames(dir, &game_files);
+  }
+  std::sort(game_files.begin(), game_files.end());
+
+  std::vector<Task> games;
+  for (size_t i = 0; i < game_files.size(); i++)
+    games.push_back(Task(game_files[i], i));
+  RunTasks(&games, true, jobs);
+
+  // Levels are only known once their games have been read.
+  std::vector<Task> levels;
+  for (size_t i = 0; i < games.size(); i++) {
+    std::string dir = DirName(games[i].filename);
+    for (size_t j = 0; j < games[i].levels.size(); j++)
+      levels.push_back(Task(dir + "/" + games[i].levels[j], i));
+  }
+  RunTasks(&levels, false, jobs);
+
+  int num_errors = PrintErrors(games) + PrintErrors(levels);
+
+  if (write_stamps) {
+    for (size_t i = 0; i < games.size(); i++) {
+      if (!WriteStamp(games, levels, i))
+        num_errors++;
+    }
+  }
+
+  printf("validated %d game(s) and %d level(s) with %d thread(s): "
+         "%d error(s)\n", static_cast<int>(games.size()),
+         static_cast<int>(levels.size()), jobs, num_errors);
+  return num_errors ? 1 : 0;
+}